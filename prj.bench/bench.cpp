@@ -0,0 +1,351 @@
+#include "bench.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace bench {
+
+namespace {
+
+std::string escape(const std::string& str) {
+  std::string res;
+  for (const char ch : str) {
+    if (ch == '"' || ch == '\\') {
+      res += '\\';
+    }
+    res += ch;
+  }
+  return res;
+}
+
+//! Minimal JSON reader, enough for the files written by WriteJson.
+class JsonReader {
+public:
+  struct Value {
+    enum class Kind { Null, Bool, Number, String, Array, Object } kind = Kind::Null;
+    double num = 0.0;
+    std::string str;
+    std::vector<Value> items;
+    std::map<std::string, Value> fields;
+
+    const Value* field(const std::string& key) const {
+      const auto it = fields.find(key);
+      return it == fields.end() ? nullptr : &it->second;
+    }
+  };
+
+  explicit JsonReader(std::string text) : text_(std::move(text)) {}
+
+  Value parse() {
+    Value val = value();
+    skip();
+    if (pos_ != text_.size()) {
+      fail("trailing data");
+    }
+    return val;
+  }
+
+private:
+  std::string text_;
+  std::size_t pos_ = 0;
+
+  [[noreturn]] void fail(const char* what) const {
+    throw std::runtime_error(std::string("bench::ReadJson - ") + what + " at offset " + std::to_string(pos_));
+  }
+
+  void skip() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  char peek() {
+    skip();
+    if (pos_ >= text_.size()) {
+      fail("unexpected end");
+    }
+    return text_[pos_];
+  }
+
+  void expect(const char ch) {
+    if (peek() != ch) {
+      fail("unexpected character");
+    }
+    ++pos_;
+  }
+
+  std::string string() {
+    expect('"');
+    std::string res;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+        ++pos_;
+      }
+      res += text_[pos_++];
+    }
+    expect('"');
+    return res;
+  }
+
+  Value value() {
+    Value val;
+    const char ch = peek();
+    if (ch == '{') {
+      val.kind = Value::Kind::Object;
+      ++pos_;
+      if (peek() == '}') {
+        ++pos_;
+        return val;
+      }
+      for (;;) {
+        std::string key = string();
+        expect(':');
+        val.fields[key] = value();
+        if (peek() == '}') {
+          ++pos_;
+          return val;
+        }
+        expect(',');
+      }
+    }
+    if (ch == '[') {
+      val.kind = Value::Kind::Array;
+      ++pos_;
+      if (peek() == ']') {
+        ++pos_;
+        return val;
+      }
+      for (;;) {
+        val.items.push_back(value());
+        if (peek() == ']') {
+          ++pos_;
+          return val;
+        }
+        expect(',');
+      }
+    }
+    if (ch == '"') {
+      val.kind = Value::Kind::String;
+      val.str = string();
+      return val;
+    }
+    for (const char* word : { "true", "false", "null" }) {
+      if (text_.compare(pos_, std::strlen(word), word) == 0) {
+        pos_ += std::strlen(word);
+        val.kind = word[0] == 'n' ? Value::Kind::Null : Value::Kind::Bool;
+        val.num = word[0] == 't' ? 1.0 : 0.0;
+        return val;
+      }
+    }
+    const char* begin = text_.c_str() + pos_;
+    char* end = nullptr;
+    val.num = std::strtod(begin, &end);
+    if (end == begin) {
+      fail("invalid value");
+    }
+    val.kind = Value::Kind::Number;
+    pos_ += end - begin;
+    return val;
+  }
+};
+
+}
+
+double median(std::vector<double> vals) {
+  if (vals.empty()) {
+    return 0.0;
+  }
+  const auto mid = vals.begin() + vals.size() / 2;
+  std::nth_element(vals.begin(), mid, vals.end());
+  if (vals.size() % 2 == 1) {
+    return *mid;
+  }
+  return (*mid + *std::max_element(vals.begin(), mid)) / 2.0;
+}
+
+double mad(const std::vector<double>& vals) {
+  const double med = median(vals);
+  std::vector<double> dev;
+  dev.reserve(vals.size());
+  for (const double v : vals) {
+    dev.push_back(std::abs(v - med));
+  }
+  return median(dev);
+}
+
+Suite::Suite(std::string name, int argc, char** argv)
+  : name_(std::move(name)) {
+  const auto usage = [&](std::ostream& ostrm) {
+    ostrm << "usage: bench_" << name_
+      << " [--reps N] [--warmup N] [--min-time MS] [--filter STR] [--json FILE]" << std::endl;
+  };
+  // Whole-string numbers only: "12x" is an error, not 12.
+  const auto to_number = [](const std::string& val, auto parse) {
+    std::size_t used = 0;
+    try {
+      const auto num = parse(val, &used);
+      if (used == val.size()) {
+        return num;
+      }
+    } catch (const std::logic_error&) {
+      // std::stoi/std::stod: invalid_argument or out_of_range.
+    }
+    throw std::invalid_argument("not a number: " + val);
+  };
+  const auto to_int = [&](const std::string& val) {
+    return to_number(val, [](const std::string& str, std::size_t* used) { return std::stoi(str, used); });
+  };
+  const auto to_double = [&](const std::string& val) {
+    return to_number(val, [](const std::string& str, std::size_t* used) { return std::stod(str, used); });
+  };
+  try {
+    for (int i = 1; i < argc; ++i) {
+      const std::string arg = argv[i];
+      if (arg == "--help" || arg == "-h") {
+        usage(std::cout);
+        std::exit(0);
+      }
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("missing value for " + arg);
+      }
+      const std::string val = argv[++i];
+      if (arg == "--reps") {
+        opts_.reps = std::max(1, to_int(val));
+      } else if (arg == "--warmup") {
+        opts_.warmup = std::max(0, to_int(val));
+      } else if (arg == "--min-time") {
+        opts_.min_rep_ms = to_double(val);
+      } else if (arg == "--filter") {
+        opts_.filter = val;
+      } else if (arg == "--json") {
+        opts_.json_path = val;
+      } else {
+        throw std::invalid_argument("unknown option " + arg);
+      }
+    }
+  } catch (const std::exception& ex) {
+    std::cerr << "bench_" << name_ << ": " << ex.what() << std::endl;
+    usage(std::cerr);
+    std::exit(2);
+  }
+}
+
+bool Suite::enabled(const std::string& name) const {
+  return opts_.filter.empty() || name.find(opts_.filter) != std::string::npos;
+}
+
+void Suite::metric(const std::string& name, const double value, const std::string& unit) {
+  if (enabled(name)) {
+    metrics_.push_back({ name, value, unit });
+  }
+}
+
+void Suite::record(const std::string& name, const std::int64_t iters, const std::int64_t items,
+  std::vector<double>& samples, const std::int64_t bytes) {
+  const double per = 1.0 / (double(iters) * double(items));
+  for (auto& s : samples) {
+    s *= per;
+  }
+  Result res;
+  res.name = name;
+  res.iters = iters;
+  res.items = items;
+  res.median_ns = median(samples);
+  res.mad_ns = mad(samples);
+  res.min_ns = *std::min_element(samples.begin(), samples.end());
+  res.bytes = bytes;
+  results_.push_back(res);
+  std::fprintf(stdout, "%-48s %12.2f ns %10.2f mad", name.c_str(), res.median_ns, res.mad_ns);
+  if (0 < bytes) {
+    std::fprintf(stdout, " %10.2f GB/s", double(bytes) / res.median_ns);
+  }
+  std::fprintf(stdout, "\n");
+  std::fflush(stdout);
+}
+
+int Suite::finish() {
+  for (const auto& m : metrics_) {
+    std::fprintf(stdout, "%-48s %12.6g %s\n", m.name.c_str(), m.value, m.unit.c_str());
+  }
+  if (!opts_.json_path.empty()) {
+    std::ofstream ofstrm(opts_.json_path);
+    WriteJson(ofstrm, name_, results_, metrics_);
+    if (!ofstrm) {
+      std::cerr << "bench: cannot write " << opts_.json_path << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+std::ostream& WriteJson(std::ostream& ostrm, const std::string& suite,
+  const std::vector<Result>& results, const std::vector<Metric>& metrics) {
+  ostrm << std::setprecision(17);
+  ostrm << "{\n  \"suite\": \"" << escape(suite) << "\",\n  \"results\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    ostrm << (i == 0 ? "\n" : ",\n")
+      << "    {\"name\": \"" << escape(r.name) << "\", \"iters\": " << r.iters
+      << ", \"items\": " << r.items << ", \"median_ns\": " << r.median_ns
+      << ", \"mad_ns\": " << r.mad_ns << ", \"min_ns\": " << r.min_ns
+      << ", \"bytes\": " << r.bytes << "}";
+  }
+  ostrm << "\n  ],\n  \"metrics\": [";
+  for (std::size_t i = 0; i < metrics.size(); ++i) {
+    const Metric& m = metrics[i];
+    ostrm << (i == 0 ? "\n" : ",\n")
+      << "    {\"name\": \"" << escape(m.name) << "\", \"value\": " << m.value
+      << ", \"unit\": \"" << escape(m.unit) << "\"}";
+  }
+  ostrm << "\n  ]\n}\n";
+  return ostrm;
+}
+
+std::vector<Result> ReadJson(std::istream& istrm) {
+  std::stringstream buf;
+  buf << istrm.rdbuf();
+  const auto root = JsonReader(buf.str()).parse();
+  const auto* list = root.field("results");
+  if (list == nullptr) {
+    throw std::runtime_error("bench::ReadJson - no results");
+  }
+  std::vector<Result> results;
+  for (const auto& item : list->items) {
+    const auto* name = item.field("name");
+    const auto* med = item.field("median_ns");
+    if (name == nullptr || med == nullptr) {
+      throw std::runtime_error("bench::ReadJson - incomplete result");
+    }
+    Result r;
+    r.name = name->str;
+    r.median_ns = med->num;
+    if (const auto* v = item.field("mad_ns")) {
+      r.mad_ns = v->num;
+    }
+    if (const auto* v = item.field("min_ns")) {
+      r.min_ns = v->num;
+    }
+    if (const auto* v = item.field("iters")) {
+      r.iters = static_cast<std::int64_t>(v->num);
+    }
+    if (const auto* v = item.field("items")) {
+      r.items = static_cast<std::int64_t>(v->num);
+    }
+    if (const auto* v = item.field("bytes")) {
+      r.bytes = static_cast<std::int64_t>(v->num);
+    }
+    results.push_back(r);
+  }
+  return results;
+}
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+#ifndef BENCH_BENCH_HPP_20261019
+#define BENCH_BENCH_HPP_20261019
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+//! MAD of a normal sample times this constant estimates its sigma.
+constexpr double kMadToSigma = 1.4826;
+
+//! Keeps a value alive so the optimizer cannot drop the computation.
+template<class T>
+inline void keep(const T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(val) : "memory");
+#else
+  static volatile const void* sink = nullptr;
+  sink = &val;
+#endif
+}
+
+struct Options {
+  std::int32_t warmup = 3;      //!< repetitions thrown away before measuring
+  std::int32_t reps = 15;       //!< measured repetitions
+  double min_rep_ms = 20.0;     //!< calibration target for one repetition
+  std::string filter;           //!< run only cases whose name contains filter
+  std::string json_path;        //!< write results here in addition to the table
+};
+
+struct Result {
+  std::string name;
+  std::int64_t iters = 0;       //!< body calls per repetition
+  std::int64_t items = 1;       //!< items processed by one body call
+  double median_ns = 0.0;       //!< per item
+  double mad_ns = 0.0;          //!< median absolute deviation, per item
+  double min_ns = 0.0;
+  std::int64_t bytes = 0;       //!< bytes touched per item, 0 if unknown
+};
+
+//! Value that is reported but not timed (memory footprint, error bound...).
+struct Metric {
+  std::string name;
+  double value = 0.0;
+  std::string unit;
+};
+
+//! One benchmark executable: parses the command line, runs cases, reports.
+//! Command line: [--reps N] [--warmup N] [--min-time MS] [--filter STR] [--json FILE]
+//! A bad command line prints the usage and exits with status 2.
+class Suite {
+public:
+  Suite(std::string name, int argc, char** argv);
+  Suite(const Suite&) = delete;
+  Suite& operator=(const Suite&) = delete;
+  ~Suite() = default;
+
+  //! Times body(); one call processes items items touching bytes bytes each.
+  template<class F>
+  void run(const std::string& name, const std::int64_t items, F&& body, const std::int64_t bytes = 0);
+
+  void metric(const std::string& name, const double value, const std::string& unit);
+
+  [[nodiscard]] bool enabled(const std::string& name) const;
+
+  //! Prints the table, writes JSON if requested. Returns process exit code.
+  int finish();
+
+  [[nodiscard]] const std::vector<Result>& results() const noexcept { return results_; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::string name_;
+  Options opts_;
+  std::vector<Result> results_;
+  std::vector<Metric> metrics_;
+
+  void record(const std::string& name, const std::int64_t iters, const std::int64_t items,
+    std::vector<double>& samples, const std::int64_t bytes);
+};
+
+[[nodiscard]] double median(std::vector<double> vals);
+[[nodiscard]] double mad(const std::vector<double>& vals);
+
+std::ostream& WriteJson(std::ostream& ostrm, const std::string& suite,
+  const std::vector<Result>& results, const std::vector<Metric>& metrics);
+
+//! Reads results written by WriteJson, throws std::runtime_error on bad input.
+std::vector<Result> ReadJson(std::istream& istrm);
+
+template<class F>
+void Suite::run(const std::string& name, const std::int64_t items, F&& body, const std::int64_t bytes) {
+  if (!enabled(name)) {
+    return;
+  }
+  // Calibrate iterations so one repetition takes at least min_rep_ms.
+  std::int64_t iters = 1;
+  for (;;) {
+    const auto start = Clock::now();
+    for (std::int64_t i = 0; i < iters; ++i) {
+      body();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (opts_.min_rep_ms <= ms || (std::int64_t(1) << 30) <= iters) {
+      break;
+    }
+    const double grow = ms <= 0.0 ? 16.0 : std::min(100.0, 1.2 * opts_.min_rep_ms / ms);
+    iters = std::max(iters + 1, static_cast<std::int64_t>(iters * grow));
+  }
+  for (std::int32_t r = 0; r < opts_.warmup; ++r) {
+    for (std::int64_t i = 0; i < iters; ++i) {
+      body();
+    }
+  }
+  std::vector<double> samples;
+  samples.reserve(opts_.reps);
+  for (std::int32_t r = 0; r < opts_.reps; ++r) {
+    const auto start = Clock::now();
+    for (std::int64_t i = 0; i < iters; ++i) {
+      body();
+    }
+    samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+  }
+  record(name, iters, items, samples, bytes);
+}
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "bench.hpp"
+
+#include <arrayd/arrayd_expr.hpp>
+
+#include <string>
+
+namespace {
+
+//! Eager element-wise ops, one temporary per operator, as a baseline for
+//! the fused expression templates.
+template<class Op>
+ArrayD eager(const ArrayD& lhs, const ArrayD& rhs, Op op) {
+  ArrayD res(lhs.size());
+  const float* l = lhs.data();
+  const float* r = rhs.data();
+  float* dst = res.data();
+  for (std::ptrdiff_t i = 0; i < res.size(); ++i) {
+    dst[i] = op(l[i], r[i]);
+  }
+  return res;
+}
+
+const auto kAdd = [](const float a, const float b) { return a + b; };
+const auto kMul = [](const float a, const float b) { return a * b; };
+
+}
+
+int main(int argc, char** argv) {
+  bench::Suite suite("arrayd", argc, argv);
+
+  for (const std::ptrdiff_t size : { 64, 4096, 262144 }) {
+    const std::string tag = "/" + std::to_string(size);
+    ArrayD arr(size);
+
+    // insert + remove keep the size fixed, so repetitions see the same work.
+    suite.run("arrayd/insert_remove_front" + tag, 1, [&] {
+      arr.insert(0, 1.0f);
+      arr.remove(0);
+      bench::keep(arr[0]);
+    });
+    suite.run("arrayd/insert_remove_mid" + tag, 1, [&] {
+      arr.insert(size / 2, 1.0f);
+      arr.remove(size / 2);
+      bench::keep(arr[size / 2]);
+    });
+    suite.run("arrayd/insert_remove_back" + tag, 1, [&] {
+      arr.insert(size, 1.0f);
+      arr.remove(size);
+      bench::keep(arr[size - 1]);
+    });
+
+    suite.run("arrayd/resize_within_capacity" + tag, 1, [&] {
+      arr.resize(size / 2);
+      arr.resize(size);
+      bench::keep(arr[size - 1]);
+    });
+    suite.run("arrayd/resize_realloc" + tag, 1, [&] {
+      ArrayD fresh;
+      fresh.resize(size);
+      bench::keep(fresh[0]);
+    });
+    suite.run("arrayd/copy" + tag, size, [&] {
+      ArrayD copy(arr);
+      bench::keep(copy[0]);
+    }, 2 * static_cast<std::int64_t>(sizeof(float)));
+
+    suite.run("arrayd/index_sum" + tag, size, [&] {
+      float sum = 0.0f;
+      for (std::ptrdiff_t i = 0; i < arr.size(); ++i) {
+        sum += arr[i];
+      }
+      bench::keep(sum);
+    }, static_cast<std::int64_t>(sizeof(float)));
+  }
+
+  // a * b + c * d: eager zeroes and fills 3 fresh arrays reading 4 + 2, then
+  // copies the result into res (ArrayD has no move), 7 reads + 7 writes in
+  // total; fused reads 4 arrays and writes 1.
+  constexpr std::int64_t kEagerBytes = (7 + 7) * sizeof(float);
+  constexpr std::int64_t kFusedBytes = (4 + 1) * sizeof(float);
+  for (const std::ptrdiff_t size : { 4096, 1 << 20, 1 << 23 }) {
+    const std::string tag = "/" + std::to_string(size);
+    ArrayD a(size);
+    ArrayD b(size);
+    ArrayD c(size);
+    ArrayD d(size);
+    for (std::ptrdiff_t i = 0; i < size; ++i) {
+      a.data()[i] = 0.5f * static_cast<float>(i % 97);
+      b.data()[i] = 1.0f + static_cast<float>(i % 13);
+      c.data()[i] = 2.0f - static_cast<float>(i % 7);
+      d.data()[i] = 0.25f * static_cast<float>(i % 5);
+    }
+    ArrayD res(size);
+    suite.run("arrayd/expr_eager" + tag, size, [&] {
+      res = eager(eager(a, b, kMul), eager(c, d, kMul), kAdd);
+      bench::keep(res.data()[0]);
+    }, kEagerBytes);
+    suite.run("arrayd/expr_fused" + tag, size, [&] {
+      res = a * b + c * d;
+      bench::keep(res.data()[0]);
+    }, kFusedBytes);
+    suite.run("arrayd/dot_eager" + tag, size, [&] {
+      const ArrayD prod = eager(a, b, kMul);
+      float acc = 0.0f;
+      for (std::ptrdiff_t i = 0; i < size; ++i) {
+        acc += prod.data()[i];
+      }
+      bench::keep(acc);
+    }, 4 * sizeof(float));
+    suite.run("arrayd/dot_fused" + tag, size, [&] {
+      bench::keep(dot(a, b));
+    }, 2 * sizeof(float));
+  }
+  suite.metric("arrayd/expr_eager_bytes_per_item", kEagerBytes, "bytes");
+  suite.metric("arrayd/expr_fused_bytes_per_item", kFusedBytes, "bytes");
+
+  return suite.finish();
+}
@@ -0,0 +1,130 @@
+#include "bench.hpp"
+
+#include <bitsetc/bitsetc.hpp>
+
+#include <bit>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::uint32_t kUniverse = std::uint32_t(1) << 22;
+constexpr std::int64_t kProbes = 4096;
+
+//! Flat word array, the baseline BitsetC is compared against.
+struct FlatBitset {
+  std::vector<std::uint64_t> words = std::vector<std::uint64_t>(kUniverse / 64, 0);
+
+  void set(const std::uint32_t idx) { words[idx >> 6] |= std::uint64_t(1) << (idx & 63); }
+  bool get(const std::uint32_t idx) const { return (words[idx >> 6] >> (idx & 63)) & 1; }
+  std::int64_t count() const {
+    std::int64_t card = 0;
+    for (const auto w : words) {
+      card += std::popcount(w);
+    }
+    return card;
+  }
+  std::size_t bytes() const { return words.size() * sizeof(std::uint64_t); }
+};
+
+FlatBitset operator&(const FlatBitset& lhs, const FlatBitset& rhs) {
+  FlatBitset res;
+  for (std::size_t i = 0; i < res.words.size(); ++i) {
+    res.words[i] = lhs.words[i] & rhs.words[i];
+  }
+  return res;
+}
+
+FlatBitset operator|(const FlatBitset& lhs, const FlatBitset& rhs) {
+  FlatBitset res;
+  for (std::size_t i = 0; i < res.words.size(); ++i) {
+    res.words[i] = lhs.words[i] | rhs.words[i];
+  }
+  return res;
+}
+
+//! Uniform random set with exactly density * kUniverse elements. Positions
+//! are drawn without replacement; dense sets start full and clear the
+//! complement, so at most half the universe is ever drawn.
+void fill(const double density, const std::uint32_t seed, FlatBitset& flat, BitsetC& comp) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<std::uint32_t> pos(0, kUniverse - 1);
+  const auto target = static_cast<std::int64_t>(density * kUniverse);
+  const bool dense = density >= 0.5;
+  if (dense) {
+    comp.set_range(0, kUniverse - 1);
+    for (auto& w : flat.words) {
+      w = ~std::uint64_t(0);
+    }
+  }
+  std::int64_t drawn = 0;
+  while (drawn < (dense ? kUniverse - target : target)) {
+    const std::uint32_t idx = pos(gen);
+    if (flat.get(idx) != dense) {
+      continue;
+    }
+    flat.words[idx >> 6] ^= std::uint64_t(1) << (idx & 63);
+    comp.set(idx, !dense);
+    ++drawn;
+  }
+  comp.optimize();
+}
+
+std::string percent(const double density) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%g%%", density * 100.0);
+  return buf;
+}
+
+}
+
+int main(int argc, char** argv) {
+  bench::Suite suite("bitsetc", argc, argv);
+
+  std::vector<std::uint32_t> probes(kProbes);
+  std::mt19937 gen(7);
+  for (auto& p : probes) {
+    p = gen() % kUniverse;
+  }
+
+  for (const double density : { 0.00001, 0.0001, 0.001, 0.01, 0.1, 0.5, 0.9, 0.99 }) {
+    const std::string tag = "/" + percent(density);
+    FlatBitset flat_a;
+    FlatBitset flat_b;
+    BitsetC comp_a;
+    BitsetC comp_b;
+    fill(density, 1, flat_a, comp_a);
+    fill(density, 2, flat_b, comp_b);
+
+    suite.metric("bitsetc/density" + tag, static_cast<double>(comp_a.count()) / kUniverse, "");
+    suite.metric("bitsetc/bytes_flat" + tag, static_cast<double>(flat_a.bytes()), "bytes");
+    suite.metric("bitsetc/bytes_compressed" + tag, static_cast<double>(comp_a.bytes()), "bytes");
+    suite.metric("bitsetc/bytes_image" + tag, static_cast<double>(comp_a.serialized_size()), "bytes");
+
+    suite.run("bitsetc/flat_and" + tag, 1, [&] { bench::keep((flat_a & flat_b).words[0]); });
+    suite.run("bitsetc/comp_and" + tag, 1, [&] { bench::keep((comp_a & comp_b).chunks()); });
+    suite.run("bitsetc/flat_or" + tag, 1, [&] { bench::keep((flat_a | flat_b).words[0]); });
+    suite.run("bitsetc/comp_or" + tag, 1, [&] { bench::keep((comp_a | comp_b).chunks()); });
+    suite.run("bitsetc/flat_count" + tag, 1, [&] { bench::keep(flat_a.count()); });
+    suite.run("bitsetc/comp_count" + tag, 1, [&] { bench::keep(comp_a.count()); });
+
+    suite.run("bitsetc/flat_get" + tag, kProbes, [&] {
+      std::int64_t hits = 0;
+      for (const auto p : probes) {
+        hits += flat_a.get(p);
+      }
+      bench::keep(hits);
+    });
+    suite.run("bitsetc/comp_get" + tag, kProbes, [&] {
+      std::int64_t hits = 0;
+      for (const auto p : probes) {
+        hits += comp_a.get(p);
+      }
+      bench::keep(hits);
+    });
+  }
+
+  return suite.finish();
+}
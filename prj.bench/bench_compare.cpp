@@ -0,0 +1,95 @@
+// Compares two JSON files written by the bench_* executables.
+// Usage: bench_compare BASE.json NEW.json [--threshold PERCENT]
+// A case regresses when its median grew by more than PERCENT (default 5)
+// and by more than three combined robust sigmas (1.4826 * MAD) of both runs.
+// Exit code is 1 when at least one case regressed.
+
+#include "bench.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::vector<bench::Result> load(const std::string& path) {
+  std::ifstream istrm(path);
+  if (!istrm) {
+    throw std::runtime_error("cannot open " + path);
+  }
+  return bench::ReadJson(istrm);
+}
+
+}
+
+int main(int argc, char** argv) {
+  const char* const usage = "usage: bench_compare BASE.json NEW.json [--threshold PERCENT]";
+  if (argc != 3 && argc != 5) {
+    std::cerr << usage << std::endl;
+    return 2;
+  }
+  double threshold = 5.0;
+  if (argc == 5) {
+    if (std::string(argv[3]) != "--threshold") {
+      std::cerr << "bench_compare: unknown option " << argv[3] << '\n' << usage << std::endl;
+      return 2;
+    }
+    const std::string val = argv[4];
+    std::size_t used = 0;
+    try {
+      threshold = std::stod(val, &used);
+    } catch (const std::exception&) {
+      used = 0;
+    }
+    if (used == 0 || used != val.size()) {
+      std::cerr << "bench_compare: not a number: " << val << '\n' << usage << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<bench::Result> base;
+  std::vector<bench::Result> next;
+  try {
+    base = load(argv[1]);
+    next = load(argv[2]);
+  } catch (const std::exception& ex) {
+    std::cerr << "bench_compare: " << ex.what() << std::endl;
+    return 2;
+  }
+
+  std::map<std::string, bench::Result> by_name;
+  for (const auto& r : base) {
+    by_name[r.name] = r;
+  }
+
+  int regressions = 0;
+  for (const auto& r : next) {
+    const auto it = by_name.find(r.name);
+    if (it == by_name.end()) {
+      std::printf("%-48s %12s %12.2f  new\n", r.name.c_str(), "-", r.median_ns);
+      continue;
+    }
+    const bench::Result& b = it->second;
+    const double delta = r.median_ns - b.median_ns;
+    const double pct = b.median_ns == 0.0 ? 0.0 : 100.0 * delta / b.median_ns;
+    const double noise = 3.0 * bench::kMadToSigma * std::hypot(b.mad_ns, r.mad_ns);
+    const char* verdict = "";
+    if (pct > threshold && delta > noise) {
+      verdict = "REGRESSION";
+      ++regressions;
+    } else if (-pct > threshold && -delta > noise) {
+      verdict = "improved";
+    }
+    std::printf("%-48s %12.2f %12.2f %+8.2f%%  %s\n", r.name.c_str(), b.median_ns, r.median_ns, pct, verdict);
+    by_name.erase(it);
+  }
+  for (const auto& [name, b] : by_name) {
+    std::printf("%-48s %12.2f %12s  missing\n", name.c_str(), b.median_ns, "-");
+  }
+  std::printf("%d regression(s)\n", regressions);
+  return regressions == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+#include "bench.hpp"
+
+#include <complex/complex_policy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kBlock = 1024;
+
+std::vector<Complex> random_values(const std::uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+  std::vector<Complex> vals;
+  vals.reserve(kBlock);
+  for (std::int64_t i = 0; i < kBlock; ++i) {
+    vals.emplace_back(dist(gen), dist(gen));
+  }
+  return vals;
+}
+
+//! Division case whose quotient is known exactly.
+struct Exact {
+  Complex num;
+  Complex den;
+  Complex quot;
+};
+
+//! quot = 2^eq (a + bi) and den = 2^ed (c + di) with 20-bit integers a..d, so
+//! num = quot * den = 2^(eq + ed) ((ac - bd) + (ad + bc)i) has at most 42
+//! significant bits and is exact in double. No extended precision needed.
+//! eq and ed are drawn from [-range, range], keeping num inside the range.
+std::vector<Exact> random_exact(const std::uint32_t seed, const int range, const std::int64_t count) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<std::int64_t> mant(-(1 << 20), 1 << 20);
+  std::uniform_int_distribution<int> exp(-range, range);
+  std::vector<Exact> vals;
+  vals.reserve(count);
+  while (static_cast<std::int64_t>(vals.size()) < count) {
+    const std::int64_t a = mant(gen);
+    const std::int64_t b = mant(gen);
+    const std::int64_t c = mant(gen);
+    const std::int64_t d = mant(gen);
+    const int eq = exp(gen);
+    const int ed = exp(gen);
+    if ((a == 0 && b == 0) || (c == 0 && d == 0) || eq + ed < -1000 || 960 < eq + ed) {
+      continue;
+    }
+    const auto scaled = [](const std::int64_t v, const int e) { return std::ldexp(static_cast<double>(v), e); };
+    vals.push_back({ Complex(scaled(a * c - b * d, eq + ed), scaled(a * d + b * c, eq + ed)),
+      Complex(scaled(c, ed), scaled(d, ed)), Complex(scaled(a, eq), scaled(b, eq)) });
+  }
+  return vals;
+}
+
+//! Largest relative error (max norm) against the exact quotient and the
+//! number of results that are not finite or off by more than 1e-13.
+//! Returns the failures.
+template<class Policy>
+std::int64_t accuracy(bench::Suite& suite, const std::string& name, const std::vector<Exact>& cases) {
+  double worst = 0.0;
+  std::int64_t failures = 0;
+  for (const Exact& e : cases) {
+    const Complex q = divide<Policy>(e.num, e.den);
+    const double ref_abs = std::max(std::abs(e.quot.re), std::abs(e.quot.im));
+    const double err = std::max(std::abs(q.re - e.quot.re), std::abs(q.im - e.quot.im)) / ref_abs;
+    if (!std::isfinite(q.re) || !std::isfinite(q.im) || !(err <= 1e-13)) {
+      ++failures;
+      continue;
+    }
+    worst = std::max(worst, err);
+  }
+  suite.metric("complex/accuracy_" + name + "_max_rel_err", worst, "");
+  suite.metric("complex/accuracy_" + name + "_failures", static_cast<double>(failures), "of " + std::to_string(cases.size()));
+  return failures;
+}
+
+}
+
+int main(int argc, char** argv) {
+  bench::Suite suite("complex", argc, argv);
+
+  const std::vector<Complex> lhs = random_values(1);
+  const std::vector<Complex> rhs = random_values(2);
+  std::vector<Complex> out(kBlock);
+
+  suite.run("complex/add", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] + rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/sub", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] - rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/mul", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] * rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/div", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] / rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/div_naive", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = divide<complex_div::Naive>(lhs[i], rhs[i]);
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/div_smith", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = divide<complex_div::Smith>(lhs[i], rhs[i]);
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/div_scaled", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = divide<complex_div::Scaled>(lhs[i], rhs[i]);
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/div_scalar", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] / rhs[i].re;
+    }
+    bench::keep(out);
+  });
+  suite.run("complex/equal", kBlock, [&] {
+    std::int64_t eq = 0;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      eq += lhs[i] == rhs[i];
+    }
+    bench::keep(eq);
+  });
+
+  suite.run("complex/equal_relative", kBlock, [&] {
+    std::int64_t eq = 0;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      eq += equal<complex_eq::Relative<>>(lhs[i], rhs[i]);
+    }
+    bench::keep(eq);
+  });
+  suite.run("complex/equal_ulps", kBlock, [&] {
+    std::int64_t eq = 0;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      eq += equal<complex_eq::Ulps<>>(lhs[i], rhs[i]);
+    }
+    bench::keep(eq);
+  });
+
+  suite.run("complex/write", kBlock, [&] {
+    std::ostringstream ostrm;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      ostrm << lhs[i];
+    }
+    bench::keep(ostrm.tellp());
+  });
+
+  std::ostringstream text;
+  for (const auto& z : lhs) {
+    text << z << ' ';
+  }
+  const std::string input = text.str();
+  suite.run("complex/read", kBlock, [&] {
+    std::istringstream istrm(input);
+    Complex z;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      istrm >> z;
+    }
+    bench::keep(z);
+  });
+
+  // Naive is expected to fail beyond 2^511; Smith and Scaled must not.
+  bool accurate = true;
+  for (const int range : { 20, 600, 1000 }) {
+    constexpr std::int64_t kSamples = 100000;
+    const auto cases = random_exact(3, range, kSamples);
+    const std::string tag = "2^" + std::to_string(range);
+    accuracy<complex_div::Naive>(suite, "naive/" + tag, cases);
+    const std::int64_t smith = accuracy<complex_div::Smith>(suite, "smith/" + tag, cases);
+    const std::int64_t scaled = accuracy<complex_div::Scaled>(suite, "scaled/" + tag, cases);
+    if (0 < smith + scaled) {
+      std::cerr << "bench_complex: inaccurate division at " << tag
+        << " (smith " << smith << ", scaled " << scaled << " failures)" << std::endl;
+      accurate = false;
+    }
+  }
+
+  const int status = suite.finish();
+  return status != 0 ? status : (accurate ? 0 : 1);
+}
@@ -0,0 +1,54 @@
+#include "bench.hpp"
+
+#include <dio/dio.hpp>
+
+#include <string>
+
+namespace {
+
+constexpr std::int64_t kBlock = 1024;
+
+}
+
+int main(int argc, char** argv) {
+  bench::Suite suite("dio", argc, argv);
+
+  suite.run("dio/write_int", kBlock, [&] {
+    DioStrB dio;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      dio << static_cast<int>(i * 7919) << ' ';
+    }
+    bench::keep(dio.str().size());
+  });
+  suite.run("dio/write_double", kBlock, [&] {
+    DioStrB dio;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      dio << i * 0.125 << ' ';
+    }
+    bench::keep(dio.str().size());
+  });
+  const std::string word = "token";
+  suite.run("dio/write_string", kBlock, [&] {
+    DioStrB dio;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      dio << word << ' ';
+    }
+    bench::keep(dio.str().size());
+  });
+
+  DioStrB text;
+  for (std::int64_t i = 0; i < kBlock; ++i) {
+    text << static_cast<int>(i) << ' ';
+  }
+  const std::string input = text.str();
+  suite.run("dio/read_tokens", kBlock, [&] {
+    DioStrB dio(input);
+    std::string tok;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      dio >> tok;
+    }
+    bench::keep(tok.size());
+  });
+
+  return suite.finish();
+}
@@ -0,0 +1,266 @@
+#include "bench.hpp"
+
+#include <rational/rational_index.hpp>
+#include <rational/rational_map.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kBlock = 1024;
+
+std::vector<Rational> random_values(const std::uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<std::int32_t> num(-10000, 10000);
+  std::uniform_int_distribution<std::int32_t> den(1, 10000);
+  std::vector<Rational> vals;
+  vals.reserve(kBlock);
+  for (std::int64_t i = 0; i < kBlock; ++i) {
+    const std::int32_t n = num(gen);
+    vals.emplace_back(n == 0 ? 1 : n, den(gen));
+  }
+  return vals;
+}
+
+//! count distinct keys drawn from a wide range, so maps see few collisions.
+std::vector<Rational> random_keys(const std::uint32_t seed, const std::int64_t count) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<std::int32_t> num(-1000000, 1000000);
+  std::uniform_int_distribution<std::int32_t> den(1, 1000000);
+  RationalMap<char> seen;
+  std::vector<Rational> keys;
+  keys.reserve(count);
+  while (static_cast<std::int64_t>(keys.size()) < count) {
+    const Rational key(num(gen), den(gen));
+    if (seen.insert(key, 0)) {
+      keys.push_back(key);
+    }
+  }
+  return keys;
+}
+
+std::vector<double> random_doubles(const std::uint32_t seed, const std::int64_t count) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+  std::vector<double> vals(count);
+  for (double& val : vals) {
+    val = dist(gen);
+  }
+  return vals;
+}
+
+//! The loop from_double replaces: every denominator up to max_den, each
+//! candidate normalized by the constructor.
+Rational scan_denominators(const double x, const std::int32_t max_den) {
+  Rational best(static_cast<std::int32_t>(std::lround(x)));
+  double best_err = std::abs(x - best.num());
+  for (std::int32_t den = 2; den <= max_den; ++den) {
+    const Rational cand(static_cast<std::int32_t>(std::lround(x * den)), den);
+    const double err = std::abs(x - static_cast<double>(cand.num()) / cand.den());
+    if (err < best_err) {
+      best = cand;
+      best_err = err;
+    }
+  }
+  return best;
+}
+
+//! Looks every probe up once; returns a checksum of the found values.
+template<class Find>
+void lookup(bench::Suite& suite, const std::string& name, const std::vector<Rational>& probes, Find find) {
+  suite.run(name, static_cast<std::int64_t>(probes.size()), [&] {
+    std::int64_t sum = 0;
+    for (const Rational& key : probes) {
+      const std::int64_t* val = find(key);
+      sum += val == nullptr ? 0 : *val;
+    }
+    bench::keep(sum);
+  });
+}
+
+}
+
+int main(int argc, char** argv) {
+  bench::Suite suite("rational", argc, argv);
+
+  const std::vector<Rational> lhs = random_values(1);
+  const std::vector<Rational> rhs = random_values(2);
+  std::vector<Rational> out(kBlock);
+
+  suite.run("rational/add", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] + rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/sub", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] - rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/mul", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] * rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/div", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = lhs[i] / rhs[i];
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/ctor_normalize", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = Rational(lhs[i].num() * 6, lhs[i].den() * 6);
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/less", kBlock, [&] {
+    std::int64_t lt = 0;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      lt += lhs[i] < rhs[i];
+    }
+    bench::keep(lt);
+  });
+
+  suite.run("rational/hash", kBlock, [&] {
+    std::size_t acc = 0;
+    const std::hash<Rational> hasher;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      acc ^= hasher(lhs[i]);
+    }
+    bench::keep(acc);
+  });
+
+  suite.run("rational/write", kBlock, [&] {
+    std::ostringstream ostrm;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      ostrm << lhs[i] << ' ';
+    }
+    bench::keep(ostrm.tellp());
+  });
+
+  std::ostringstream text;
+  for (const auto& q : lhs) {
+    text << q << ' ';
+  }
+  const std::string input = text.str();
+  suite.run("rational/read", kBlock, [&] {
+    std::istringstream istrm(input);
+    Rational q;
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      istrm >> q;
+    }
+    bench::keep(q);
+  });
+
+  const std::vector<double> reals = random_doubles(5, kBlock);
+  for (const std::int32_t max_den : { 100, 1000000, std::numeric_limits<std::int32_t>::max() }) {
+    suite.run("rational/from_double/" + std::to_string(max_den), kBlock, [&] {
+      for (std::int64_t i = 0; i < kBlock; ++i) {
+        out[i] = Rational::from_double(reals[i], max_den);
+      }
+      bench::keep(out);
+    });
+  }
+  suite.run("rational/from_double_scan/100", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = scan_denominators(reals[i], 100);
+    }
+    bench::keep(out);
+  });
+  suite.run("rational/continued_fraction", kBlock, [&] {
+    for (std::int64_t i = 0; i < kBlock; ++i) {
+      out[i] = Rational::from_continued_fraction(lhs[i].continued_fraction());
+    }
+    bench::keep(out);
+  });
+
+  {
+    constexpr std::int64_t kBatch = 1 << 22;
+    const std::vector<double> src = random_doubles(6, kBatch);
+    std::vector<Rational> dst(kBatch);
+    suite.run("rational/from_double_serial/" + std::to_string(kBatch), kBatch, [&] {
+      for (std::int64_t i = 0; i < kBatch; ++i) {
+        dst[i] = Rational::from_double(src[i]);
+      }
+      bench::keep(dst);
+    }, sizeof(double) + sizeof(Rational));
+    suite.run("rational/from_double_batch/" + std::to_string(kBatch), kBatch, [&] {
+      Rational::from_double(src, dst);
+      bench::keep(dst);
+    }, sizeof(double) + sizeof(Rational));
+    suite.metric("rational/from_double_batch_threads", std::thread::hardware_concurrency(), "threads");
+  }
+
+  // Hits probe the stored keys in random order, misses a disjoint key set.
+  for (const std::int64_t size : { 1024, 100000 }) {
+    const std::string tag = "/" + std::to_string(size);
+    const std::vector<Rational> all = random_keys(3, 2 * size);
+    const std::vector<Rational> keys(all.begin(), all.begin() + size);
+    std::vector<Rational> hits = keys;
+    std::shuffle(hits.begin(), hits.end(), std::mt19937(4));
+    const std::vector<Rational> misses(all.begin() + size, all.end());
+
+    RationalMap<std::int64_t> flat;
+    std::unordered_map<Rational, std::int64_t> unordered;
+    std::map<Rational, std::int64_t> ordered;
+    std::vector<std::pair<Rational, std::int64_t>> entries;
+    for (std::int64_t i = 0; i < size; ++i) {
+      flat.insert(keys[i], i);
+      unordered.emplace(keys[i], i);
+      ordered.emplace(keys[i], i);
+      entries.emplace_back(keys[i], i);
+    }
+    RationalIndex<std::int64_t> index;
+    index.assign(std::move(entries));
+
+    const auto find_flat = [&](const Rational& key) { return flat.find(key); };
+    const auto find_index = [&](const Rational& key) { return index.find(key); };
+    const auto find_unordered = [&](const Rational& key) -> const std::int64_t* {
+      const auto it = unordered.find(key);
+      return it == unordered.end() ? nullptr : &it->second;
+    };
+    const auto find_ordered = [&](const Rational& key) -> const std::int64_t* {
+      const auto it = ordered.find(key);
+      return it == ordered.end() ? nullptr : &it->second;
+    };
+    for (const bool hit : { true, false }) {
+      const std::string suffix = (hit ? "_hit" : "_miss") + tag;
+      const std::vector<Rational>& probes = hit ? hits : misses;
+      lookup(suite, "rational/map_find" + suffix, probes, find_flat);
+      lookup(suite, "rational/index_find" + suffix, probes, find_index);
+      lookup(suite, "rational/unordered_map_find" + suffix, probes, find_unordered);
+      lookup(suite, "rational/std_map_find" + suffix, probes, find_ordered);
+    }
+
+    suite.run("rational/map_insert" + tag, size, [&] {
+      RationalMap<std::int64_t> fresh;
+      for (std::int64_t i = 0; i < size; ++i) {
+        fresh.insert(keys[i], i);
+      }
+      bench::keep(fresh.size());
+    });
+    suite.run("rational/unordered_map_insert" + tag, size, [&] {
+      std::unordered_map<Rational, std::int64_t> fresh;
+      for (std::int64_t i = 0; i < size; ++i) {
+        fresh.emplace(keys[i], i);
+      }
+      bench::keep(fresh.size());
+    });
+  }
+
+  return suite.finish();
+}
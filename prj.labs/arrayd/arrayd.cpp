@@ -1,4 +1,5 @@
 #include <arrayd/arrayd.hpp>
+#include <instr/instr.hpp>
 
 #include <cstring>
 #include <stdexcept>
@@ -34,6 +35,7 @@ ArrayD& ArrayD::operator=(const ArrayD& rhs) {
 }
 
 void ArrayD::resize(const std::ptrdiff_t size) { 
+  LABS_INSTR_SCOPE("ArrayD::resize");
   if (size < 0) {
     throw std::invalid_argument("ArrayD::resize - non positive size");
   }
@@ -69,6 +71,7 @@ float ArrayD::operator[](const std::ptrdiff_t idx) const {
 }
 
 void ArrayD::insert(const std::ptrdiff_t idx, const float val) {
+  LABS_INSTR_SCOPE("ArrayD::insert");
   if (idx < 0 || size_ < idx) {
     throw std::invalid_argument("ArrayD::Insert - invalid index");
   }
@@ -81,11 +84,12 @@ void ArrayD::insert(const std::ptrdiff_t idx, const float val) {
 
 
 void ArrayD::remove(const std::ptrdiff_t idx) { 
+  LABS_INSTR_SCOPE("ArrayD::remove");
   if (idx < 0 || size_ <= idx) {
     throw std::invalid_argument("ArrayD::operator[] - invalid index");
   }
   if (idx != size_ - 1) {
-    std::memmove(data_ + idx, data_ + idx + 1, (size_ - idx) * sizeof(float));
+    std::memmove(data_ + idx, data_ + idx + 1, (size_ - idx - 1) * sizeof(float));
   }
   resize(size_ - 1);
 }
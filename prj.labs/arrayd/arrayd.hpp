@@ -4,18 +4,29 @@
 
 #include <cstddef>
 
+template<class E>
+class ArrayExpr;
+
 class ArrayD {
 public:
   ArrayD() = default;
 
   ArrayD(const ArrayD&);
 
+  //! Evaluates a lazy element-wise expression (see arrayd_expr.hpp).
+  template<class E>
+  ArrayD(const ArrayExpr<E>& expr);
+
   ArrayD(const std::ptrdiff_t size);
   
   ~ArrayD();
   
   ArrayD& operator=(const ArrayD&);
 
+  //! Evaluates expr in a single pass; expr may refer to *this.
+  template<class E>
+  ArrayD& operator=(const ArrayExpr<E>& expr);
+
   [[nodiscard]] std::ptrdiff_t size() const noexcept { return size_; }
 
   void resize(const std::ptrdiff_t size);
@@ -23,6 +34,9 @@ public:
   [[nodiscard]] float& operator[](const std::ptrdiff_t idx);
   [[nodiscard]] float operator[](const std::ptrdiff_t idx) const;
 
+  [[nodiscard]] float* data() noexcept { return data_; }
+  [[nodiscard]] const float* data() const noexcept { return data_; }
+
   void insert(const std::ptrdiff_t idx, const float val);
 
 
@@ -0,0 +1,242 @@
+#pragma once
+#ifndef ARRAYD_ARRAYD_EXPR_HPP_20261019
+#define ARRAYD_ARRAYD_EXPR_HPP_20261019
+
+#include <arrayd/arrayd.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include <type_traits>
+
+//! Lazy element-wise arithmetic over ArrayD.
+//!
+//! a * b + c * d builds an expression tree instead of temporaries; assigning
+//! it to an ArrayD (or passing it to a reduction) evaluates all of it in one
+//! loop without allocations. Expressions hold pointers to the arrays they
+//! use, so they must not outlive them or survive their resize.
+
+template<class E>
+class ArrayExpr {
+public:
+  [[nodiscard]] const E& self() const noexcept { return static_cast<const E&>(*this); }
+
+  //! Size of the expression; -1 for a scalar broadcast to any size.
+  [[nodiscard]] std::ptrdiff_t size() const noexcept { return self().size(); }
+
+  //! Unchecked element access.
+  [[nodiscard]] float operator[](const std::ptrdiff_t idx) const noexcept { return self()[idx]; }
+};
+
+namespace arrayd_expr {
+
+class Ref : public ArrayExpr<Ref> {
+public:
+  explicit Ref(const ArrayD& arr) noexcept : data_(arr.data()), size_(arr.size()) {}
+
+  [[nodiscard]] std::ptrdiff_t size() const noexcept { return size_; }
+  [[nodiscard]] float operator[](const std::ptrdiff_t idx) const noexcept { return data_[idx]; }
+
+private:
+  const float* data_ = nullptr;
+  std::ptrdiff_t size_ = 0;
+};
+
+class Scalar : public ArrayExpr<Scalar> {
+public:
+  explicit Scalar(const float val) noexcept : val_(val) {}
+
+  [[nodiscard]] std::ptrdiff_t size() const noexcept { return -1; }
+  [[nodiscard]] float operator[](const std::ptrdiff_t) const noexcept { return val_; }
+
+private:
+  float val_ = 0.0f;
+};
+
+struct Add { static float apply(const float a, const float b) noexcept { return a + b; } };
+struct Sub { static float apply(const float a, const float b) noexcept { return a - b; } };
+struct Mul { static float apply(const float a, const float b) noexcept { return a * b; } };
+struct Div { static float apply(const float a, const float b) noexcept { return a / b; } };
+
+template<class Op, class L, class R>
+class Binary : public ArrayExpr<Binary<Op, L, R>> {
+public:
+  Binary(const L& lhs, const R& rhs)
+    : lhs_(lhs)
+    , rhs_(rhs)
+    , size_(std::max(lhs.size(), rhs.size())) {
+    if (0 <= lhs.size() && 0 <= rhs.size() && lhs.size() != rhs.size()) {
+      throw std::invalid_argument("ArrayExpr - size mismatch");
+    }
+  }
+
+  [[nodiscard]] std::ptrdiff_t size() const noexcept { return size_; }
+  [[nodiscard]] float operator[](const std::ptrdiff_t idx) const noexcept {
+    return Op::apply(lhs_[idx], rhs_[idx]);
+  }
+
+private:
+  L lhs_;
+  R rhs_;
+  std::ptrdiff_t size_ = 0;
+};
+
+template<class A>
+class Negate : public ArrayExpr<Negate<A>> {
+public:
+  explicit Negate(const A& arg) noexcept : arg_(arg) {}
+
+  [[nodiscard]] std::ptrdiff_t size() const noexcept { return arg_.size(); }
+  [[nodiscard]] float operator[](const std::ptrdiff_t idx) const noexcept { return -arg_[idx]; }
+
+private:
+  A arg_;
+};
+
+template<class T>
+struct IsExpr : std::is_base_of<ArrayExpr<T>, T> {};
+
+//! ArrayD, an expression or a scalar.
+template<class T>
+concept Operand = std::same_as<T, ArrayD> || IsExpr<T>::value || std::convertible_to<T, float>;
+
+//! At least one side of a binary operator must be an array operand.
+template<class T>
+concept ArrayOperand = std::same_as<T, ArrayD> || IsExpr<T>::value;
+
+inline Ref wrap(const ArrayD& arr) noexcept { return Ref(arr); }
+
+template<class E>
+const E& wrap(const ArrayExpr<E>& expr) noexcept { return expr.self(); }
+
+template<class T>
+  requires std::convertible_to<T, float> && (!ArrayOperand<T>)
+Scalar wrap(const T& val) noexcept { return Scalar(static_cast<float>(val)); }
+
+template<class T>
+using Wrapped = std::remove_cvref_t<decltype(wrap(std::declval<const T&>()))>;
+
+template<class Op, class L, class R>
+Binary<Op, Wrapped<L>, Wrapped<R>> make(const L& lhs, const R& rhs) {
+  return { wrap(lhs), wrap(rhs) };
+}
+
+}
+
+template<class L, class R>
+  requires arrayd_expr::Operand<L> && arrayd_expr::Operand<R>
+    && (arrayd_expr::ArrayOperand<L> || arrayd_expr::ArrayOperand<R>)
+[[nodiscard]] auto operator+(const L& lhs, const R& rhs) {
+  return arrayd_expr::make<arrayd_expr::Add>(lhs, rhs);
+}
+
+template<class L, class R>
+  requires arrayd_expr::Operand<L> && arrayd_expr::Operand<R>
+    && (arrayd_expr::ArrayOperand<L> || arrayd_expr::ArrayOperand<R>)
+[[nodiscard]] auto operator-(const L& lhs, const R& rhs) {
+  return arrayd_expr::make<arrayd_expr::Sub>(lhs, rhs);
+}
+
+template<class L, class R>
+  requires arrayd_expr::Operand<L> && arrayd_expr::Operand<R>
+    && (arrayd_expr::ArrayOperand<L> || arrayd_expr::ArrayOperand<R>)
+[[nodiscard]] auto operator*(const L& lhs, const R& rhs) {
+  return arrayd_expr::make<arrayd_expr::Mul>(lhs, rhs);
+}
+
+template<class L, class R>
+  requires arrayd_expr::Operand<L> && arrayd_expr::Operand<R>
+    && (arrayd_expr::ArrayOperand<L> || arrayd_expr::ArrayOperand<R>)
+[[nodiscard]] auto operator/(const L& lhs, const R& rhs) {
+  return arrayd_expr::make<arrayd_expr::Div>(lhs, rhs);
+}
+
+template<class A>
+  requires arrayd_expr::ArrayOperand<A>
+[[nodiscard]] auto operator-(const A& arg) {
+  return arrayd_expr::Negate<arrayd_expr::Wrapped<A>>(arrayd_expr::wrap(arg));
+}
+
+//! Reductions evaluate the expression directly, nothing is materialized.
+//! sum keeps several partial sums so the loop vectorizes without -ffast-math.
+template<class A>
+  requires arrayd_expr::ArrayOperand<A>
+[[nodiscard]] float sum(const A& arg) {
+  const auto expr = arrayd_expr::wrap(arg);
+  const std::ptrdiff_t size = expr.size();
+  constexpr std::ptrdiff_t kLanes = 8;
+  float part[kLanes] = {};
+  std::ptrdiff_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (std::ptrdiff_t k = 0; k < kLanes; ++k) {
+      part[k] += expr[i + k];
+    }
+  }
+  float res = 0.0f;
+  for (; i < size; ++i) {
+    res += expr[i];
+  }
+  for (std::ptrdiff_t k = 0; k < kLanes; ++k) {
+    res += part[k];
+  }
+  return res;
+}
+
+template<class L, class R>
+  requires arrayd_expr::ArrayOperand<L> && arrayd_expr::ArrayOperand<R>
+[[nodiscard]] float dot(const L& lhs, const R& rhs) {
+  return sum(lhs * rhs);
+}
+
+template<class A>
+  requires arrayd_expr::ArrayOperand<A>
+[[nodiscard]] float min(const A& arg) {
+  const auto expr = arrayd_expr::wrap(arg);
+  if (expr.size() <= 0) {
+    throw std::invalid_argument("ArrayExpr::min - empty expression");
+  }
+  float res = expr[0];
+  for (std::ptrdiff_t i = 1; i < expr.size(); ++i) {
+    res = std::min(res, expr[i]);
+  }
+  return res;
+}
+
+template<class A>
+  requires arrayd_expr::ArrayOperand<A>
+[[nodiscard]] float max(const A& arg) {
+  const auto expr = arrayd_expr::wrap(arg);
+  if (expr.size() <= 0) {
+    throw std::invalid_argument("ArrayExpr::max - empty expression");
+  }
+  float res = expr[0];
+  for (std::ptrdiff_t i = 1; i < expr.size(); ++i) {
+    res = std::max(res, expr[i]);
+  }
+  return res;
+}
+
+template<class E>
+ArrayD::ArrayD(const ArrayExpr<E>& expr) {
+  *this = expr;
+}
+
+template<class E>
+ArrayD& ArrayD::operator=(const ArrayExpr<E>& expr) {
+  const E& src = expr.self();
+  if (src.size() < 0) {
+    throw std::invalid_argument("ArrayD::operator= - scalar expression");
+  }
+  // If *this takes part in src the sizes already match and resize keeps data_.
+  if (size_ != src.size()) {
+    resize(src.size());
+  }
+  float* dst = data_;
+  const std::ptrdiff_t size = size_;
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    dst[i] = src[i];
+  }
+  return *this;
+}
+
+#endif
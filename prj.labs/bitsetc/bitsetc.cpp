@@ -0,0 +1,945 @@
+#include <bitsetc/bitsetc.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using Container = BitsetC::Container;
+using Interval = BitsetC::Interval;
+using Kind = BitsetC::Kind;
+
+constexpr std::uint32_t kMagic = 0x31534252;  // "RBS1"
+constexpr std::size_t kHeaderBytes = 8;
+constexpr std::size_t kDescBytes = 16;
+
+// Array-array intersection switches to galloping beyond this size ratio.
+constexpr std::size_t kGallopRatio = 64;
+
+std::int32_t run_length(const Interval& r) noexcept {
+  return static_cast<std::int32_t>(r.last) - r.start + 1;
+}
+
+void set_bits(std::vector<std::uint64_t>& words, const std::int32_t first, const std::int32_t last) noexcept {
+  const std::int32_t wf = first >> 6;
+  const std::int32_t wl = last >> 6;
+  const std::uint64_t mf = ~std::uint64_t(0) << (first & 63);
+  const std::uint64_t ml = ~std::uint64_t(0) >> (63 - (last & 63));
+  if (wf == wl) {
+    words[wf] |= mf & ml;
+    return;
+  }
+  words[wf] |= mf;
+  for (std::int32_t w = wf + 1; w < wl; ++w) {
+    words[w] = ~std::uint64_t(0);
+  }
+  words[wl] |= ml;
+}
+
+std::int32_t popcount(const std::vector<std::uint64_t>& words) noexcept {
+  std::int32_t card = 0;
+  for (const auto w : words) {
+    card += std::popcount(w);
+  }
+  return card;
+}
+
+std::int32_t count_runs(const std::vector<std::uint64_t>& words) noexcept {
+  std::int32_t runs = 0;
+  std::uint64_t carry = 0;
+  for (const auto w : words) {
+    // A run starts at every set bit whose predecessor is clear.
+    runs += std::popcount(w & ~((w << 1) | carry));
+    carry = w >> 63;
+  }
+  return runs;
+}
+
+std::vector<std::uint64_t> to_bitmap(const Container& c) {
+  if (c.kind == Kind::Bitmap) {
+    return c.bitmap;
+  }
+  std::vector<std::uint64_t> words(BitsetC::kBitmapWords, 0);
+  if (c.kind == Kind::Array) {
+    for (const auto v : c.array) {
+      words[v >> 6] |= std::uint64_t(1) << (v & 63);
+    }
+  } else {
+    for (const auto& r : c.runs) {
+      set_bits(words, r.start, r.last);
+    }
+  }
+  return words;
+}
+
+std::vector<Interval> to_runs(const Container& c) {
+  if (c.kind == Kind::Run) {
+    return c.runs;
+  }
+  std::vector<Interval> runs;
+  if (c.kind == Kind::Array) {
+    for (const auto v : c.array) {
+      if (!runs.empty() && runs.back().last + 1 == v) {
+        runs.back().last = v;
+      } else {
+        runs.push_back({ v, v });
+      }
+    }
+    return runs;
+  }
+  std::int32_t start = -1;
+  for (std::int32_t i = 0; i < BitsetC::kBitmapWords * 64; ++i) {
+    const bool bit = (c.bitmap[i >> 6] >> (i & 63)) & 1;
+    if (bit && start < 0) {
+      start = i;
+    } else if (!bit && 0 <= start) {
+      runs.push_back({ static_cast<std::uint16_t>(start), static_cast<std::uint16_t>(i - 1) });
+      start = -1;
+    }
+  }
+  if (0 <= start) {
+    runs.push_back({ static_cast<std::uint16_t>(start), 0xFFFF });
+  }
+  return runs;
+}
+
+std::vector<std::uint16_t> to_array(const Container& c) {
+  if (c.kind == Kind::Array) {
+    return c.array;
+  }
+  std::vector<std::uint16_t> array;
+  array.reserve(c.card);
+  if (c.kind == Kind::Run) {
+    for (const auto& r : c.runs) {
+      for (std::int32_t v = r.start; v <= r.last; ++v) {
+        array.push_back(static_cast<std::uint16_t>(v));
+      }
+    }
+    return array;
+  }
+  for (std::int32_t w = 0; w < BitsetC::kBitmapWords; ++w) {
+    std::uint64_t bits = c.bitmap[w];
+    while (bits != 0) {
+      array.push_back(static_cast<std::uint16_t>((w << 6) + std::countr_zero(bits)));
+      bits &= bits - 1;
+    }
+  }
+  return array;
+}
+
+Container make_array(std::vector<std::uint16_t>&& array) {
+  Container c;
+  c.kind = Kind::Array;
+  c.card = static_cast<std::int32_t>(array.size());
+  c.array = std::move(array);
+  return c;
+}
+
+//! Bitmap result of an operation, demoted to an array when sparse enough.
+Container make_from_bitmap(std::vector<std::uint64_t>&& words, const std::int32_t card) {
+  Container c;
+  c.card = card;
+  c.bitmap = std::move(words);
+  c.kind = Kind::Bitmap;
+  if (card <= BitsetC::kArrayMax) {
+    c.array = to_array(c);
+    c.bitmap = {};
+    c.kind = Kind::Array;
+  }
+  return c;
+}
+
+//! Picks the smallest of array / bitmap / run for a container with known runs.
+void choose_best(Container& c, const std::int32_t nruns) {
+  const std::size_t run_bytes = std::size_t(nruns) * sizeof(Interval);
+  const std::size_t array_bytes = std::size_t(c.card) * sizeof(std::uint16_t);
+  const std::size_t bitmap_bytes = std::size_t(BitsetC::kBitmapWords) * sizeof(std::uint64_t);
+  Kind best = c.card <= BitsetC::kArrayMax ? Kind::Array : Kind::Bitmap;
+  if (run_bytes < std::min(array_bytes, bitmap_bytes)) {
+    best = Kind::Run;
+  }
+  if (best == c.kind) {
+    return;
+  }
+  Container res;
+  res.kind = best;
+  res.card = c.card;
+  if (best == Kind::Array) {
+    res.array = to_array(c);
+  } else if (best == Kind::Bitmap) {
+    res.bitmap = to_bitmap(c);
+  } else {
+    res.runs = to_runs(c);
+  }
+  c = std::move(res);
+}
+
+Container make_runs(std::vector<Interval>&& runs) {
+  Container c;
+  c.kind = Kind::Run;
+  for (const auto& r : runs) {
+    c.card += run_length(r);
+  }
+  c.runs = std::move(runs);
+  choose_best(c, static_cast<std::int32_t>(c.runs.size()));
+  return c;
+}
+
+bool contains(const Container& c, const std::uint16_t v) noexcept {
+  switch (c.kind) {
+  case Kind::Array:
+    return std::binary_search(c.array.begin(), c.array.end(), v);
+  case Kind::Bitmap:
+    return (c.bitmap[v >> 6] >> (v & 63)) & 1;
+  case Kind::Run: {
+    auto it = std::upper_bound(c.runs.begin(), c.runs.end(), v,
+      [](const std::uint16_t val, const Interval& r) { return val < r.start; });
+    return it != c.runs.begin() && v <= (it - 1)->last;
+  }
+  }
+  return false;
+}
+
+// --- intersection -----------------------------------------------------------
+
+Container and_array_array(const std::vector<std::uint16_t>& a, const std::vector<std::uint16_t>& b) {
+  const auto& small = a.size() <= b.size() ? a : b;
+  const auto& large = a.size() <= b.size() ? b : a;
+  std::vector<std::uint16_t> res;
+  res.reserve(small.size());
+  if (small.size() * kGallopRatio < large.size()) {
+    auto lo = large.begin();
+    for (const auto v : small) {
+      lo = std::lower_bound(lo, large.end(), v);
+      if (lo == large.end()) {
+        break;
+      }
+      if (*lo == v) {
+        res.push_back(v);
+      }
+    }
+  } else {
+    std::set_intersection(small.begin(), small.end(), large.begin(), large.end(),
+      std::back_inserter(res));
+  }
+  return make_array(std::move(res));
+}
+
+Container and_array_bitmap(const std::vector<std::uint16_t>& a, const std::vector<std::uint64_t>& b) {
+  std::vector<std::uint16_t> res;
+  res.reserve(a.size());
+  for (const auto v : a) {
+    if ((b[v >> 6] >> (v & 63)) & 1) {
+      res.push_back(v);
+    }
+  }
+  return make_array(std::move(res));
+}
+
+Container and_array_run(const std::vector<std::uint16_t>& a, const std::vector<Interval>& b) {
+  std::vector<std::uint16_t> res;
+  res.reserve(a.size());
+  auto r = b.begin();
+  for (const auto v : a) {
+    while (r != b.end() && r->last < v) {
+      ++r;
+    }
+    if (r == b.end()) {
+      break;
+    }
+    if (r->start <= v) {
+      res.push_back(v);
+    }
+  }
+  return make_array(std::move(res));
+}
+
+Container and_bitmap_bitmap(const std::vector<std::uint64_t>& a, const std::vector<std::uint64_t>& b) {
+  std::vector<std::uint64_t> words(BitsetC::kBitmapWords);
+  std::int32_t card = 0;
+  for (std::int32_t i = 0; i < BitsetC::kBitmapWords; ++i) {
+    words[i] = a[i] & b[i];
+    card += std::popcount(words[i]);
+  }
+  return make_from_bitmap(std::move(words), card);
+}
+
+Container and_bitmap_run(const std::vector<std::uint64_t>& a, const std::vector<Interval>& b) {
+  std::vector<std::uint64_t> mask(BitsetC::kBitmapWords, 0);
+  for (const auto& r : b) {
+    set_bits(mask, r.start, r.last);
+  }
+  std::int32_t card = 0;
+  for (std::int32_t i = 0; i < BitsetC::kBitmapWords; ++i) {
+    mask[i] &= a[i];
+    card += std::popcount(mask[i]);
+  }
+  return make_from_bitmap(std::move(mask), card);
+}
+
+Container and_run_run(const std::vector<Interval>& a, const std::vector<Interval>& b) {
+  std::vector<Interval> res;
+  auto i = a.begin();
+  auto j = b.begin();
+  while (i != a.end() && j != b.end()) {
+    const std::uint16_t start = std::max(i->start, j->start);
+    const std::uint16_t last = std::min(i->last, j->last);
+    if (start <= last) {
+      res.push_back({ start, last });
+    }
+    if (i->last < j->last) {
+      ++i;
+    } else {
+      ++j;
+    }
+  }
+  return make_runs(std::move(res));
+}
+
+Container intersect(const Container& a, const Container& b) {
+  if (b.kind < a.kind) {
+    return intersect(b, a);
+  }
+  switch (a.kind) {
+  case Kind::Array:
+    if (b.kind == Kind::Array) {
+      return and_array_array(a.array, b.array);
+    }
+    return b.kind == Kind::Bitmap ? and_array_bitmap(a.array, b.bitmap) : and_array_run(a.array, b.runs);
+  case Kind::Bitmap:
+    return b.kind == Kind::Bitmap ? and_bitmap_bitmap(a.bitmap, b.bitmap) : and_bitmap_run(a.bitmap, b.runs);
+  case Kind::Run:
+    return and_run_run(a.runs, b.runs);
+  }
+  return {};
+}
+
+// --- union ------------------------------------------------------------------
+
+Container or_array_array(const std::vector<std::uint16_t>& a, const std::vector<std::uint16_t>& b) {
+  if (a.size() + b.size() <= std::size_t(BitsetC::kArrayMax)) {
+    std::vector<std::uint16_t> res;
+    res.reserve(a.size() + b.size());
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(res));
+    return make_array(std::move(res));
+  }
+  std::vector<std::uint64_t> words(BitsetC::kBitmapWords, 0);
+  for (const auto v : a) {
+    words[v >> 6] |= std::uint64_t(1) << (v & 63);
+  }
+  for (const auto v : b) {
+    words[v >> 6] |= std::uint64_t(1) << (v & 63);
+  }
+  const std::int32_t card = popcount(words);
+  return make_from_bitmap(std::move(words), card);
+}
+
+Container or_bitmap_any(const std::vector<std::uint64_t>& a, const Container& b) {
+  std::vector<std::uint64_t> words(a);
+  switch (b.kind) {
+  case Kind::Array:
+    for (const auto v : b.array) {
+      words[v >> 6] |= std::uint64_t(1) << (v & 63);
+    }
+    break;
+  case Kind::Bitmap:
+    for (std::int32_t i = 0; i < BitsetC::kBitmapWords; ++i) {
+      words[i] |= b.bitmap[i];
+    }
+    break;
+  case Kind::Run:
+    for (const auto& r : b.runs) {
+      set_bits(words, r.start, r.last);
+    }
+    break;
+  }
+  const std::int32_t card = popcount(words);
+  Container c;
+  c.kind = Kind::Bitmap;
+  c.card = card;
+  c.bitmap = std::move(words);
+  return c;
+}
+
+Container or_run_run(const std::vector<Interval>& a, const std::vector<Interval>& b) {
+  std::vector<Interval> res;
+  res.reserve(a.size() + b.size());
+  auto i = a.begin();
+  auto j = b.begin();
+  while (i != a.end() || j != b.end()) {
+    const bool take_a = j == b.end() || (i != a.end() && i->start <= j->start);
+    const Interval r = take_a ? *i++ : *j++;
+    if (!res.empty() && r.start <= res.back().last + 1) {
+      res.back().last = std::max(res.back().last, r.last);
+    } else {
+      res.push_back(r);
+    }
+  }
+  return make_runs(std::move(res));
+}
+
+Container unite(const Container& a, const Container& b) {
+  if (b.kind < a.kind) {
+    return unite(b, a);
+  }
+  if (b.kind == Kind::Bitmap) {
+    return or_bitmap_any(b.bitmap, a);
+  }
+  if (a.kind == Kind::Array && b.kind == Kind::Array) {
+    return or_array_array(a.array, b.array);
+  }
+  // array | run and run | run merge as interval lists.
+  return or_run_run(to_runs(a), b.runs);
+}
+
+// --- serialization ----------------------------------------------------------
+
+// Images are the in-memory layout copied byte for byte (load/store and the
+// payload memcpy use host order); only little-endian hosts write the format.
+static_assert(std::endian::native == std::endian::little, "BitsetC images are little-endian");
+
+template<class T>
+T load(const unsigned char* p) noexcept {
+  T val;
+  std::memcpy(&val, p, sizeof(T));
+  return val;
+}
+
+template<class T>
+void store(unsigned char* p, const T val) noexcept {
+  std::memcpy(p, &val, sizeof(T));
+}
+
+std::size_t align8(const std::size_t n) noexcept {
+  return (n + 7) & ~std::size_t(7);
+}
+
+std::size_t payload_bytes(const Kind kind, const std::uint32_t elements) noexcept {
+  switch (kind) {
+  case Kind::Array:
+    return std::size_t(elements) * sizeof(std::uint16_t);
+  case Kind::Bitmap:
+    return std::size_t(elements) * sizeof(std::uint64_t);
+  case Kind::Run:
+    return std::size_t(elements) * sizeof(Interval);
+  }
+  return 0;
+}
+
+struct Desc {
+  std::uint16_t key = 0;
+  Kind kind = Kind::Array;
+  std::uint32_t card = 0;
+  std::uint32_t elements = 0;
+  std::uint32_t offset = 0;
+};
+
+Desc load_desc(const unsigned char* image, const std::ptrdiff_t i) noexcept {
+  const unsigned char* p = image + kHeaderBytes + i * kDescBytes;
+  Desc d;
+  d.key = load<std::uint16_t>(p);
+  d.kind = static_cast<Kind>(p[2]);
+  d.card = load<std::uint32_t>(p + 4);
+  d.elements = load<std::uint32_t>(p + 8);
+  d.offset = load<std::uint32_t>(p + 12);
+  return d;
+}
+
+//! True if the descriptor is well formed and its payload starts at offset,
+//! the position WriteTo gives it: payloads are packed in descriptor order.
+bool check_desc(const Desc& d, const std::size_t offset) noexcept {
+  return d.kind <= Kind::Run && d.elements <= 0x10000 && d.offset == offset
+    && (d.kind != Kind::Bitmap || d.elements == BitsetC::kBitmapWords);
+}
+
+//! True if the payload agrees with d.card and is in canonical order: arrays
+//! strictly increasing, runs with start <= last and separated by a gap.
+bool check_payload(const Desc& d, const unsigned char* payload) noexcept {
+  std::uint64_t card = 0;
+  switch (d.kind) {
+  case Kind::Array:
+    for (std::uint32_t i = 1; i < d.elements; ++i) {
+      const std::size_t at = i * sizeof(std::uint16_t);
+      if (load<std::uint16_t>(payload + at) <= load<std::uint16_t>(payload + at - sizeof(std::uint16_t))) {
+        return false;
+      }
+    }
+    card = d.elements;
+    break;
+  case Kind::Bitmap:
+    for (std::uint32_t w = 0; w < d.elements; ++w) {
+      card += std::popcount(load<std::uint64_t>(payload + w * sizeof(std::uint64_t)));
+    }
+    break;
+  case Kind::Run: {
+    std::int32_t prev_last = -2;
+    for (std::uint32_t i = 0; i < d.elements; ++i) {
+      const unsigned char* entry = payload + i * sizeof(Interval);
+      const std::int32_t start = load<std::uint16_t>(entry);
+      const std::int32_t last = load<std::uint16_t>(entry + sizeof(std::uint16_t));
+      if (last < start || start <= prev_last + 1) {
+        return false;
+      }
+      card += static_cast<std::uint64_t>(last - start + 1);
+      prev_last = last;
+    }
+    break;
+  }
+  }
+  return 0 < card && card == d.card;
+}
+
+//! Validates the image (header, descriptors and every payload against its
+//! card) and returns the number of chunks in it. O(image size).
+std::ptrdiff_t check_image(const unsigned char* image, const std::size_t size) {
+  if (size < kHeaderBytes || load<std::uint32_t>(image) != kMagic) {
+    throw std::invalid_argument("BitsetC - invalid image header");
+  }
+  const std::uint32_t n = load<std::uint32_t>(image + 4);
+  if (n > 0x10000 || size < kHeaderBytes + std::size_t(n) * kDescBytes) {
+    throw std::invalid_argument("BitsetC - truncated image");
+  }
+  std::size_t offset = kHeaderBytes + std::size_t(n) * kDescBytes;
+  for (std::uint32_t i = 0; i < n; ++i) {
+    const Desc d = load_desc(image, i);
+    if (!check_desc(d, offset) || size < offset + payload_bytes(d.kind, d.elements)) {
+      throw std::invalid_argument("BitsetC - invalid image chunk");
+    }
+    offset = align8(offset + payload_bytes(d.kind, d.elements));
+    if (!check_payload(d, image + d.offset)) {
+      throw std::invalid_argument("BitsetC - inconsistent image chunk");
+    }
+    if (0 < i && d.key <= load_desc(image, i - 1).key) {
+      throw std::invalid_argument("BitsetC - unsorted image chunks");
+    }
+  }
+  return n;
+}
+
+}
+
+std::ptrdiff_t BitsetC::find(const std::uint16_t key) const noexcept {
+  const auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key) {
+    return -1;
+  }
+  return it - keys_.begin();
+}
+
+bool BitsetC::get(const std::uint32_t idx) const noexcept {
+  const std::ptrdiff_t i = find(static_cast<std::uint16_t>(idx >> 16));
+  return 0 <= i && contains(conts_[i], static_cast<std::uint16_t>(idx));
+}
+
+void BitsetC::set(const std::uint32_t idx, const bool val) {
+  const auto key = static_cast<std::uint16_t>(idx >> 16);
+  const auto low = static_cast<std::uint16_t>(idx);
+  const auto pos = std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+  const bool found = pos < std::ssize(keys_) && keys_[pos] == key;
+  if (!found) {
+    if (val) {
+      keys_.insert(keys_.begin() + pos, key);
+      conts_.insert(conts_.begin() + pos, make_array({ low }));
+    }
+    return;
+  }
+  Container& c = conts_[pos];
+  if (contains(c, low) == val) {
+    return;
+  }
+  switch (c.kind) {
+  case Kind::Array:
+    if (val) {
+      if (c.card == kArrayMax) {
+        c.bitmap = to_bitmap(c);
+        c.array = {};
+        c.kind = Kind::Bitmap;
+        c.bitmap[low >> 6] |= std::uint64_t(1) << (low & 63);
+      } else {
+        c.array.insert(std::lower_bound(c.array.begin(), c.array.end(), low), low);
+      }
+    } else {
+      c.array.erase(std::lower_bound(c.array.begin(), c.array.end(), low));
+    }
+    break;
+  case Kind::Bitmap:
+    c.bitmap[low >> 6] ^= std::uint64_t(1) << (low & 63);
+    break;
+  case Kind::Run: {
+    auto it = std::upper_bound(c.runs.begin(), c.runs.end(), low,
+      [](const std::uint16_t v, const Interval& r) { return v < r.start; });
+    if (val) {
+      const bool join_left = it != c.runs.begin() && (it - 1)->last + 1 == low;
+      const bool join_right = it != c.runs.end() && it->start == low + 1;
+      if (join_left && join_right) {
+        (it - 1)->last = it->last;
+        c.runs.erase(it);
+      } else if (join_left) {
+        (it - 1)->last = low;
+      } else if (join_right) {
+        it->start = low;
+      } else {
+        c.runs.insert(it, { low, low });
+      }
+    } else {
+      Interval& r = *(it - 1);
+      if (r.start == r.last) {
+        c.runs.erase(it - 1);
+      } else if (r.start == low) {
+        r.start += 1;
+      } else if (r.last == low) {
+        r.last -= 1;
+      } else {
+        const Interval tail{ static_cast<std::uint16_t>(low + 1), r.last };
+        r.last = static_cast<std::uint16_t>(low - 1);
+        c.runs.insert(it, tail);
+      }
+    }
+    break;
+  }
+  }
+  c.card += val ? 1 : -1;
+  if (c.card == 0) {
+    keys_.erase(keys_.begin() + pos);
+    conts_.erase(conts_.begin() + pos);
+  } else if (c.kind == Kind::Bitmap && c.card <= kArrayMax) {
+    c.array = to_array(c);
+    c.bitmap = {};
+    c.kind = Kind::Array;
+  } else if (c.kind == Kind::Run) {
+    // Single-bit edits split and merge runs; re-pick the form once the runs
+    // outgrow a bitmap or the container fits an array.
+    const std::size_t run_bytes = c.runs.size() * sizeof(Interval);
+    if (c.card <= kArrayMax || std::size_t(kBitmapWords) * sizeof(std::uint64_t) < run_bytes) {
+      choose_best(c, static_cast<std::int32_t>(c.runs.size()));
+    }
+  }
+}
+
+void BitsetC::set_range(const std::uint32_t first, const std::uint32_t last) {
+  if (last < first) {
+    throw std::invalid_argument("BitsetC::set_range - invalid range");
+  }
+  for (std::uint32_t key = first >> 16; key <= (last >> 16); ++key) {
+    const auto lo = static_cast<std::uint16_t>(key == (first >> 16) ? first : 0);
+    const auto hi = static_cast<std::uint16_t>(key == (last >> 16) ? last : 0xFFFF);
+    Container range = make_runs({ { lo, hi } });
+    const auto pos = std::lower_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+    if (pos < std::ssize(keys_) && keys_[pos] == key) {
+      conts_[pos] = unite(conts_[pos], range);
+    } else {
+      keys_.insert(keys_.begin() + pos, static_cast<std::uint16_t>(key));
+      conts_.insert(conts_.begin() + pos, std::move(range));
+    }
+  }
+}
+
+std::int64_t BitsetC::count() const noexcept {
+  std::int64_t card = 0;
+  for (const auto& c : conts_) {
+    card += c.card;
+  }
+  return card;
+}
+
+void BitsetC::clear() noexcept {
+  keys_.clear();
+  conts_.clear();
+}
+
+void BitsetC::optimize() {
+  for (auto& c : conts_) {
+    std::int32_t nruns = 0;
+    if (c.kind == Kind::Run) {
+      nruns = static_cast<std::int32_t>(c.runs.size());
+    } else if (c.kind == Kind::Bitmap) {
+      nruns = count_runs(c.bitmap);
+    } else {
+      nruns = c.card == 0 ? 0 : 1;
+      for (std::int32_t i = 1; i < c.card; ++i) {
+        nruns += c.array[i - 1] + 1 != c.array[i];
+      }
+    }
+    choose_best(c, nruns);
+    c.array.shrink_to_fit();
+    c.runs.shrink_to_fit();
+  }
+}
+
+std::size_t BitsetC::bytes() const noexcept {
+  std::size_t total = keys_.capacity() * sizeof(std::uint16_t) + conts_.capacity() * sizeof(Container);
+  for (const auto& c : conts_) {
+    total += c.array.capacity() * sizeof(std::uint16_t)
+      + c.bitmap.capacity() * sizeof(std::uint64_t)
+      + c.runs.capacity() * sizeof(Interval);
+  }
+  return total;
+}
+
+bool BitsetC::operator==(const BitsetC& rhs) const noexcept {
+  if (keys_ != rhs.keys_) {
+    return false;
+  }
+  for (std::size_t i = 0; i < conts_.size(); ++i) {
+    const Container& a = conts_[i];
+    const Container& b = rhs.conts_[i];
+    if (a.card != b.card) {
+      return false;
+    }
+    if (a.kind == b.kind) {
+      if (a.array != b.array || a.bitmap != b.bitmap || a.runs.size() != b.runs.size()) {
+        return false;
+      }
+      for (std::size_t r = 0; r < a.runs.size(); ++r) {
+        if (a.runs[r].start != b.runs[r].start || a.runs[r].last != b.runs[r].last) {
+          return false;
+        }
+      }
+    } else if (to_bitmap(a) != to_bitmap(b)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BitsetC& BitsetC::operator&=(const BitsetC& rhs) {
+  std::vector<std::uint16_t> keys;
+  std::vector<Container> conts;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < keys_.size() && j < rhs.keys_.size()) {
+    if (keys_[i] < rhs.keys_[j]) {
+      ++i;
+    } else if (rhs.keys_[j] < keys_[i]) {
+      ++j;
+    } else {
+      Container c = intersect(conts_[i], rhs.conts_[j]);
+      if (0 < c.card) {
+        keys.push_back(keys_[i]);
+        conts.push_back(std::move(c));
+      }
+      ++i;
+      ++j;
+    }
+  }
+  keys_ = std::move(keys);
+  conts_ = std::move(conts);
+  return *this;
+}
+
+BitsetC& BitsetC::operator|=(const BitsetC& rhs) {
+  std::vector<std::uint16_t> keys;
+  std::vector<Container> conts;
+  keys.reserve(keys_.size() + rhs.keys_.size());
+  conts.reserve(keys_.size() + rhs.keys_.size());
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < keys_.size() || j < rhs.keys_.size()) {
+    if (j == rhs.keys_.size() || (i < keys_.size() && keys_[i] < rhs.keys_[j])) {
+      keys.push_back(keys_[i]);
+      conts.push_back(std::move(conts_[i++]));
+    } else if (i == keys_.size() || rhs.keys_[j] < keys_[i]) {
+      keys.push_back(rhs.keys_[j]);
+      conts.push_back(rhs.conts_[j++]);
+    } else {
+      keys.push_back(keys_[i]);
+      conts.push_back(unite(conts_[i++], rhs.conts_[j++]));
+    }
+  }
+  keys_ = std::move(keys);
+  conts_ = std::move(conts);
+  return *this;
+}
+
+std::size_t BitsetC::serialized_size() const noexcept {
+  std::size_t size = kHeaderBytes + keys_.size() * kDescBytes;
+  for (const auto& c : conts_) {
+    const std::size_t elements = c.kind == Kind::Array ? c.array.size()
+      : c.kind == Kind::Bitmap ? c.bitmap.size() : c.runs.size();
+    size = align8(size + payload_bytes(c.kind, static_cast<std::uint32_t>(elements)));
+  }
+  return size;
+}
+
+void BitsetC::WriteTo(void* dst) const noexcept {
+  auto* image = static_cast<unsigned char*>(dst);
+  std::memset(image, 0, serialized_size());
+  store(image, kMagic);
+  store(image + 4, static_cast<std::uint32_t>(keys_.size()));
+  std::size_t offset = kHeaderBytes + keys_.size() * kDescBytes;
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    const Container& c = conts_[i];
+    const void* payload = c.kind == Kind::Array ? static_cast<const void*>(c.array.data())
+      : c.kind == Kind::Bitmap ? static_cast<const void*>(c.bitmap.data())
+      : static_cast<const void*>(c.runs.data());
+    const std::size_t elements = c.kind == Kind::Array ? c.array.size()
+      : c.kind == Kind::Bitmap ? c.bitmap.size() : c.runs.size();
+    const std::size_t bytes = payload_bytes(c.kind, static_cast<std::uint32_t>(elements));
+
+    unsigned char* desc = image + kHeaderBytes + i * kDescBytes;
+    store(desc, keys_[i]);
+    desc[2] = static_cast<unsigned char>(c.kind);
+    store(desc + 4, static_cast<std::uint32_t>(c.card));
+    store(desc + 8, static_cast<std::uint32_t>(elements));
+    store(desc + 12, static_cast<std::uint32_t>(offset));
+    if (0 < bytes) {
+      std::memcpy(image + offset, payload, bytes);
+    }
+    offset = align8(offset + bytes);
+  }
+}
+
+std::ostream& BitsetC::WriteTo(std::ostream& ostrm) const {
+  std::vector<unsigned char> image(serialized_size());
+  WriteTo(image.data());
+  ostrm.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+  return ostrm;
+}
+
+std::istream& BitsetC::ReadFrom(std::istream& istrm) {
+  std::vector<unsigned char> image(kHeaderBytes);
+  if (!istrm.read(reinterpret_cast<char*>(image.data()), kHeaderBytes)) {
+    return istrm;
+  }
+  const std::uint32_t n = load<std::uint32_t>(image.data() + 4);
+  if (load<std::uint32_t>(image.data()) != kMagic || n > 0x10000) {
+    istrm.setstate(std::ios_base::failbit);
+    return istrm;
+  }
+  image.resize(kHeaderBytes + std::size_t(n) * kDescBytes);
+  if (!istrm.read(reinterpret_cast<char*>(image.data()) + kHeaderBytes, n * kDescBytes)) {
+    return istrm;
+  }
+  // Payloads are read one by one in descriptor order after checking each
+  // descriptor, so the buffer never outgrows the data the stream delivers.
+  for (std::uint32_t i = 0; i < n; ++i) {
+    const Desc d = load_desc(image.data(), i);
+    if (!check_desc(d, image.size())) {
+      istrm.setstate(std::ios_base::failbit);
+      return istrm;
+    }
+    const std::size_t head = image.size();
+    image.resize(align8(head + payload_bytes(d.kind, d.elements)));
+    if (!istrm.read(reinterpret_cast<char*>(image.data()) + head, static_cast<std::streamsize>(image.size() - head))) {
+      return istrm;
+    }
+  }
+  try {
+    *this = FromImage(image.data(), image.size());
+  } catch (const std::invalid_argument&) {
+    istrm.setstate(std::ios_base::failbit);
+  }
+  return istrm;
+}
+
+BitsetC BitsetC::FromImage(const void* src, const std::size_t size) {
+  return BitsetCView(src, size).materialize();
+}
+
+BitsetCView::BitsetCView(const void* image, const std::size_t size)
+  : image_(static_cast<const unsigned char*>(image))
+  , size_(size)
+  , chunks_(check_image(image_, size_)) {
+}
+
+bool BitsetCView::get(const std::uint32_t idx) const noexcept {
+  const auto key = static_cast<std::uint16_t>(idx >> 16);
+  const auto low = static_cast<std::uint16_t>(idx);
+  std::ptrdiff_t lo = 0;
+  std::ptrdiff_t hi = chunks_;
+  while (lo < hi) {
+    const std::ptrdiff_t mid = lo + (hi - lo) / 2;
+    if (load<std::uint16_t>(image_ + kHeaderBytes + mid * kDescBytes) < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == chunks_) {
+    return false;
+  }
+  const Desc d = load_desc(image_, lo);
+  if (d.key != key) {
+    return false;
+  }
+  const unsigned char* payload = image_ + d.offset;
+  if (d.kind == Kind::Bitmap) {
+    return (load<std::uint64_t>(payload + (low >> 6) * sizeof(std::uint64_t)) >> (low & 63)) & 1;
+  }
+  // Array and run payloads are both searched for the last entry starting <= low.
+  const std::size_t stride = d.kind == Kind::Array ? sizeof(std::uint16_t) : sizeof(Interval);
+  std::uint32_t first = 0;
+  std::uint32_t count = d.elements;
+  while (0 < count) {
+    const std::uint32_t step = count / 2;
+    if (load<std::uint16_t>(payload + (first + step) * stride) <= low) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  if (first == 0) {
+    return false;
+  }
+  const unsigned char* entry = payload + (first - 1) * stride;
+  if (d.kind == Kind::Array) {
+    return load<std::uint16_t>(entry) == low;
+  }
+  return low <= load<std::uint16_t>(entry + sizeof(std::uint16_t));
+}
+
+std::int64_t BitsetCView::count() const noexcept {
+  std::int64_t card = 0;
+  for (std::ptrdiff_t i = 0; i < chunks_; ++i) {
+    card += load_desc(image_, i).card;
+  }
+  return card;
+}
+
+BitsetC BitsetCView::materialize() const {
+  BitsetC res;
+  res.keys_.reserve(chunks_);
+  res.conts_.reserve(chunks_);
+  for (std::ptrdiff_t i = 0; i < chunks_; ++i) {
+    const Desc d = load_desc(image_, i);
+    const unsigned char* payload = image_ + d.offset;
+    Container c;
+    c.kind = d.kind;
+    c.card = static_cast<std::int32_t>(d.card);
+    switch (d.kind) {
+    case Kind::Array:
+      c.array.resize(d.elements);
+      std::memcpy(c.array.data(), payload, payload_bytes(d.kind, d.elements));
+      break;
+    case Kind::Bitmap:
+      c.bitmap.resize(d.elements);
+      std::memcpy(c.bitmap.data(), payload, payload_bytes(d.kind, d.elements));
+      break;
+    case Kind::Run:
+      c.runs.resize(d.elements);
+      std::memcpy(c.runs.data(), payload, payload_bytes(d.kind, d.elements));
+      break;
+    }
+    res.keys_.push_back(d.key);
+    res.conts_.push_back(std::move(c));
+  }
+  return res;
+}
+
+BitsetC operator&(const BitsetC& lhs, const BitsetC& rhs) {
+  BitsetC res(lhs);
+  res &= rhs;
+  return res;
+}
+
+BitsetC operator|(const BitsetC& lhs, const BitsetC& rhs) {
+  BitsetC res(lhs);
+  res |= rhs;
+  return res;
+}
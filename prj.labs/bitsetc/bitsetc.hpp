@@ -0,0 +1,115 @@
+#pragma once
+#ifndef BITSETC_BITSETC_HPP_20261019
+#define BITSETC_BITSETC_HPP_20261019
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+//! Compressed set of uint32 indices (roaring-style).
+//! Universe is split into 2^16 chunks by the high 16 bits of an index,
+//! every non-empty chunk is stored as an array, bitmap or run container.
+class BitsetC {
+public:
+  enum class Kind : std::uint8_t { Array = 0, Bitmap = 1, Run = 2 };
+
+  //! Array container is kept while cardinality <= kArrayMax.
+  static constexpr std::int32_t kArrayMax = 4096;
+  static constexpr std::int32_t kBitmapWords = 1024;
+
+  struct Interval {
+    std::uint16_t start = 0;
+    std::uint16_t last = 0;  // inclusive
+  };
+
+  struct Container {
+    Kind kind = Kind::Array;
+    std::int32_t card = 0;
+    std::vector<std::uint16_t> array;   // Kind::Array, sorted
+    std::vector<std::uint64_t> bitmap;  // Kind::Bitmap, kBitmapWords words
+    std::vector<Interval> runs;         // Kind::Run, sorted, disjoint
+  };
+
+  BitsetC() = default;
+  BitsetC(const BitsetC&) = default;
+  BitsetC(BitsetC&&) noexcept = default;
+  ~BitsetC() = default;
+  BitsetC& operator=(const BitsetC&) = default;
+  BitsetC& operator=(BitsetC&&) noexcept = default;
+
+  [[nodiscard]] bool get(const std::uint32_t idx) const noexcept;
+  void set(const std::uint32_t idx, const bool val = true);
+
+  //! Sets every index in [first, last].
+  void set_range(const std::uint32_t first, const std::uint32_t last);
+
+  [[nodiscard]] std::int64_t count() const noexcept;
+  [[nodiscard]] bool empty() const noexcept { return keys_.empty(); }
+  void clear() noexcept;
+
+  //! Converts every container to its smallest representation (incl. runs).
+  void optimize();
+
+  //! Heap bytes taken by containers and chunk directory.
+  [[nodiscard]] std::size_t bytes() const noexcept;
+
+  [[nodiscard]] std::ptrdiff_t chunks() const noexcept {
+    return static_cast<std::ptrdiff_t>(keys_.size());
+  }
+  [[nodiscard]] std::uint16_t chunk_key(const std::ptrdiff_t i) const { return keys_.at(i); }
+  [[nodiscard]] const Container& chunk(const std::ptrdiff_t i) const { return conts_.at(i); }
+
+  [[nodiscard]] bool operator==(const BitsetC& rhs) const noexcept;
+  [[nodiscard]] bool operator!=(const BitsetC& rhs) const noexcept { return !operator==(rhs); }
+
+  BitsetC& operator&=(const BitsetC& rhs);
+  BitsetC& operator|=(const BitsetC& rhs);
+
+  //! Size in bytes of the serialized image (see WriteTo).
+  [[nodiscard]] std::size_t serialized_size() const noexcept;
+
+  //! Writes a little-endian image (host order; big-endian hosts are rejected
+  //! at compile time) that can be mmap-ed and read by BitsetCView.
+  //! Layout: 8 byte header {magic, chunk count}, 16 byte descriptor per chunk
+  //! {key, kind, pad, card, elements, payload offset}, then 8 byte aligned payloads.
+  std::ostream& WriteTo(std::ostream& ostrm) const;
+  void WriteTo(void* dst) const noexcept;
+
+  //! Reads an image produced by WriteTo.
+  std::istream& ReadFrom(std::istream& istrm);
+  static BitsetC FromImage(const void* src, const std::size_t size);
+
+private:
+  friend class BitsetCView;
+
+  std::vector<std::uint16_t> keys_;  // sorted high halves
+  std::vector<Container> conts_;
+
+  std::ptrdiff_t find(const std::uint16_t key) const noexcept;
+};
+
+//! Read-only view over a serialized BitsetC image (e.g. mmap-ed file).
+//! Does not copy payloads, the image must outlive the view. The constructor
+//! checks every chunk once and throws std::invalid_argument on corruption.
+class BitsetCView {
+public:
+  BitsetCView() = default;
+  BitsetCView(const void* image, const std::size_t size);
+
+  [[nodiscard]] bool get(const std::uint32_t idx) const noexcept;
+  [[nodiscard]] std::int64_t count() const noexcept;
+  [[nodiscard]] std::ptrdiff_t chunks() const noexcept { return chunks_; }
+
+  [[nodiscard]] BitsetC materialize() const;
+
+private:
+  const unsigned char* image_ = nullptr;
+  std::size_t size_ = 0;
+  std::ptrdiff_t chunks_ = 0;
+};
+
+[[nodiscard]] BitsetC operator&(const BitsetC& lhs, const BitsetC& rhs);
+[[nodiscard]] BitsetC operator|(const BitsetC& lhs, const BitsetC& rhs);
+
+#endif
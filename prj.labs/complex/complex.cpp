@@ -1,4 +1,5 @@
 #include "complex.hpp"
+#include <instr/instr.hpp>
 #include <stdexcept>
 
 Complex::Complex(const double real)
@@ -50,6 +51,7 @@ Complex& Complex::operator*=(const double rhs) {
 }
 
 Complex& Complex::operator/=(const Complex& rhs) {
+    LABS_INSTR_SCOPE("Complex::operator/=");
     const double denominator = rhs.re * rhs.re + rhs.im * rhs.im;
     if (denominator == 0.0) {
         throw std::runtime_error("division by zero");
@@ -76,6 +78,7 @@ std::ostream& Complex::writeTo(std::ostream& ostrm) const {
 }
 
 std::istream& Complex::readFrom(std::istream& istrm) {
+    LABS_INSTR_SCOPE("Complex::readFrom");
     char leftBrace0 = 0;
     double real0 = 0.0;
     char comma0 = 0;
@@ -0,0 +1,148 @@
+#ifndef COMPLEX_COMPLEX_POLICY_HPP
+#define COMPLEX_COMPLEX_POLICY_HPP
+
+#include "complex/complex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Compile-time selectable division and comparison for Complex.
+//
+//   Complex q = divide<complex_div::Smith>(a, b);
+//   bool same = equal<complex_eq::Ulps<4>>(x, y);
+//
+// Complex::operator/= and operator== are left as they are (naive formula,
+// absolute EPS); the policies are for callers that need a different
+// trade-off between range and cost.
+
+namespace complex_div {
+
+// re^2 + im^2 denominator: overflows for |rhs| > ~1e154 and underflows for
+// |rhs| < ~1e-154. No zero check and no branches, for callers that know
+// their range; division by zero gives inf/nan.
+struct Naive {
+    static Complex divide(const Complex& lhs, const Complex& rhs) noexcept {
+        const double den = rhs.re * rhs.re + rhs.im * rhs.im;
+        return Complex((lhs.re * rhs.re + lhs.im * rhs.im) / den,
+            (lhs.im * rhs.re - lhs.re * rhs.im) / den);
+    }
+};
+
+// Smith's algorithm: divides by the larger component of rhs first, so the
+// denominator never squares. One extra branch, no overflow for |rhs| up to
+// DBL_MAX; may still lose precision when the ratio underflows.
+struct Smith {
+    static Complex divide(const Complex& lhs, const Complex& rhs) {
+        if (rhs.re == 0.0 && rhs.im == 0.0) {
+            throw std::runtime_error("division by zero");
+        }
+        if (std::abs(rhs.im) <= std::abs(rhs.re)) {
+            const double r = rhs.im / rhs.re;
+            const double den = rhs.re + rhs.im * r;
+            return Complex((lhs.re + lhs.im * r) / den, (lhs.im - lhs.re * r) / den);
+        }
+        const double r = rhs.re / rhs.im;
+        const double den = rhs.re * r + rhs.im;
+        return Complex((lhs.re * r + lhs.im) / den, (lhs.im * r - lhs.re) / den);
+    }
+};
+
+// Scales both operands by exact powers of two (frexp/ldexp) into [0.5, 1),
+// divides with the naive formula and scales the result back. Correct over
+// the whole double range, overflows or underflows only if the quotient does.
+// Operands with exponents inside +-kSafeExp skip the scaling.
+struct Scaled {
+    static constexpr int kSafeExp = 500;
+
+    static Complex divide(const Complex& lhs, const Complex& rhs) {
+        if (rhs.re == 0.0 && rhs.im == 0.0) {
+            throw std::runtime_error("division by zero");
+        }
+        int exp_lhs = 0;
+        int exp_rhs = 0;
+        std::frexp(std::max(std::abs(lhs.re), std::abs(lhs.im)), &exp_lhs);
+        std::frexp(std::max(std::abs(rhs.re), std::abs(rhs.im)), &exp_rhs);
+        if (std::abs(exp_lhs) < kSafeExp && std::abs(exp_rhs) < kSafeExp) {
+            return Naive::divide(lhs, rhs);
+        }
+        const double a = std::ldexp(lhs.re, -exp_lhs);
+        const double b = std::ldexp(lhs.im, -exp_lhs);
+        const double c = std::ldexp(rhs.re, -exp_rhs);
+        const double d = std::ldexp(rhs.im, -exp_rhs);
+        const double den = c * c + d * d;
+        return Complex(std::ldexp((a * c + b * d) / den, exp_lhs - exp_rhs),
+            std::ldexp((b * c - a * d) / den, exp_lhs - exp_rhs));
+    }
+};
+
+}
+
+template<class Policy>
+Complex divide(const Complex& lhs, const Complex& rhs) {
+    return Policy::divide(lhs, rhs);
+}
+
+template<class Policy>
+Complex& divide_assign(Complex& lhs, const Complex& rhs) {
+    lhs = Policy::divide(lhs, rhs);
+    return lhs;
+}
+
+namespace complex_eq {
+
+// Same rule as Complex::operator==: each component within EPS.
+struct Absolute {
+    static bool equal(const Complex& lhs, const Complex& rhs) noexcept {
+        return lhs == rhs;
+    }
+};
+
+// |lhs - rhs| <= tol * max(|lhs|, |rhs|) in the max norm; tol = Num / Den.
+template<std::int64_t Num = 1, std::int64_t Den = 1000000000000>
+struct Relative {
+    static bool equal(const Complex& lhs, const Complex& rhs) noexcept {
+        constexpr double tol = static_cast<double>(Num) / static_cast<double>(Den);
+        const double diff = std::max(std::abs(lhs.re - rhs.re), std::abs(lhs.im - rhs.im));
+        const double scale = std::max({ std::abs(lhs.re), std::abs(lhs.im),
+            std::abs(rhs.re), std::abs(rhs.im) });
+        return diff <= tol * scale;
+    }
+};
+
+//! Number of representable doubles between a and b; max() if either is nan.
+inline std::uint64_t ulp_distance(const double a, const double b) noexcept {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+    // Map the sign-magnitude bit pattern to a monotonic unsigned scale.
+    const auto ordered = [](const double v) {
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        constexpr std::uint64_t sign = std::uint64_t(1) << 63;
+        return (bits & sign) != 0 ? sign - (bits & ~sign) : sign + bits;
+    };
+    const std::uint64_t ua = ordered(a);
+    const std::uint64_t ub = ordered(b);
+    return ua < ub ? ub - ua : ua - ub;
+}
+
+// Each component within MaxUlps representable doubles.
+template<std::uint64_t MaxUlps = 4>
+struct Ulps {
+    static bool equal(const Complex& lhs, const Complex& rhs) noexcept {
+        return ulp_distance(lhs.re, rhs.re) <= MaxUlps && ulp_distance(lhs.im, rhs.im) <= MaxUlps;
+    }
+};
+
+}
+
+template<class Policy>
+bool equal(const Complex& lhs, const Complex& rhs) {
+    return Policy::equal(lhs, rhs);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include "dio/dio.hpp"
+#include <sstream>
+
+DioStrB& DioStrB::operator<<(const std::string& str) {
+    potok +=str;
+    return *this;
+}
+
+DioStrB& DioStrB::operator<<(int num) {
+    std::stringstream ss;
+    ss << num;
+    potok += ss.str();
+    return *this;
+}
+
+DioStrB& DioStrB::operator<<(double num) {
+    std::stringstream ss;
+    ss << num;
+    potok += ss.str();
+    return *this;
+}
+
+DioStrB& DioStrB::operator<<(char ch) {
+    potok += ch;
+    return *this;
+}
+
+DioStrB& DioStrB::operator<<(char* ch) {
+    potok += ch; 
+    return *this;
+}
+
+DioStrB& DioStrB::operator>>(std::string& out) {
+    if (pos >= potok.length()) {
+        out="";
+        return *this;
+    }
+    size_t end = potok.find(' ',pos);
+    if (end == std::string::npos) {
+        out = potok.substr(pos) ;
+        pos = potok.length();
+    } else {
+        out = potok.substr(pos, end - pos);
+        pos = end+1;
+    }
+    return *this;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#ifndef DIO_DIO_HPP_20261019
+#define DIO_DIO_HPP_20261019
+
+#include <string>
+
+class DioStrB {
+private:
+    std::string potok;
+    size_t pos;
+public:
+    DioStrB() : pos(0) {}
+    DioStrB(const std::string& str) : potok(str), pos(0) {}
+
+    DioStrB& operator<<(const std::string& str);
+    DioStrB& operator<<(int num);
+    DioStrB& operator<<(double num);
+    DioStrB& operator<<(char ch);
+    DioStrB& operator<<(char* ch);
+
+    DioStrB& operator>>(std::string& out);
+
+    std::string val() {
+        return potok;
+    }
+    std::string& str() {
+        return potok;
+    }
+    const std::string&  str() const {
+        return potok;
+    }
+};
+
+#endif
@@ -0,0 +1,410 @@
+#include <instr/instr.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::int32_t kHwCounters = instr::kAllocs;
+
+const char* const kColumns[instr::kCounters] = {
+  "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "allocs", "alloc_bytes"
+};
+
+// Plain thread_local integers: no dynamic initialization, safe inside operator new.
+thread_local std::uint64_t t_allocs = 0;
+thread_local std::uint64_t t_alloc_bytes = 0;
+
+// Bit i set once hardware counter i failed to open in some thread; its
+// totals are then incomplete and the column is left out of the dump.
+std::atomic<std::uint32_t> g_hw_missing{ 0 };
+constexpr std::uint32_t kAllHwMissing = (std::uint32_t(1) << kHwCounters) - 1;
+
+// Shared site for scopes whose registration failed (e.g. bad_alloc).
+constinit instr::Site g_unregistered{ "(unregistered)" };
+
+struct Registry {
+  std::mutex mtx;
+  std::deque<instr::Site> sites;  // deque keeps element addresses stable
+};
+
+//! Leaked on purpose: sites must outlive every static destructor that may run a scope.
+Registry& registry() {
+  static Registry* reg = new Registry;
+  return *reg;
+}
+
+void DumpAtExit() noexcept {
+  const char* fmt = std::getenv("LABS_INSTR_FORMAT");
+  const instr::Format format = fmt != nullptr && std::strcmp(fmt, "json") == 0
+    ? instr::Format::Json : instr::Format::Text;
+  const char* path = std::getenv("LABS_INSTR_OUT");
+  try {
+    if (path != nullptr && *path != '\0') {
+      std::ofstream ofstrm(path);
+      instr::Dump(ofstrm, format);
+    } else {
+      instr::Dump(std::cerr, format);
+    }
+  } catch (...) {
+    // Nothing sensible left to do at exit.
+  }
+}
+
+void RegisterDumpAtExit() noexcept {
+  static std::atomic<bool> registered{ false };
+  if (!registered.exchange(true)) {
+    std::atexit(DumpAtExit);
+  }
+}
+
+#if defined(__linux__)
+
+//! Per-thread perf event group, opened on first use.
+class PerfGroup {
+public:
+  PerfGroup() {
+    static const std::pair<std::uint32_t, std::uint64_t> events[kHwCounters] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+    for (std::int32_t i = 0; i < kHwCounters; ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = events[i].first;
+      attr.config = events[i].second;
+      attr.disabled = leader_ < 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+      if (fd < 0) {
+        g_hw_missing.fetch_or(std::uint32_t(1) << i);
+        continue;
+      }
+      if (leader_ < 0) {
+        leader_ = fd;
+      }
+      slot_[i] = opened_++;
+      fds_[i] = fd;
+    }
+    if (0 <= leader_) {
+      ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  PerfGroup(const PerfGroup&) = delete;
+  PerfGroup& operator=(const PerfGroup&) = delete;
+
+  ~PerfGroup() {
+    for (const int fd : fds_) {
+      if (0 <= fd) {
+        close(fd);
+      }
+    }
+  }
+
+  void read_into(std::uint64_t* vals) const noexcept {
+    if (leader_ < 0) {
+      return;
+    }
+    std::uint64_t buf[1 + kHwCounters] = {};
+    if (read(leader_, buf, sizeof(buf)) <= 0) {
+      return;
+    }
+    for (std::int32_t i = 0; i < kHwCounters; ++i) {
+      if (0 <= slot_[i]) {
+        vals[i] = buf[1 + slot_[i]];
+      }
+    }
+  }
+
+private:
+  int leader_ = -1;
+  int opened_ = 0;
+  int fds_[kHwCounters] = { -1, -1, -1, -1, -1 };
+  int slot_[kHwCounters] = { -1, -1, -1, -1, -1 };
+};
+
+void read_hw(std::uint64_t* vals) noexcept {
+  thread_local const PerfGroup group;
+  group.read_into(vals);
+}
+
+#else
+
+void read_hw(std::uint64_t*) noexcept {
+  g_hw_missing.store(kAllHwMissing);
+}
+
+#endif
+
+}
+
+namespace instr {
+
+Site* Register(const char* name) noexcept {
+  RegisterDumpAtExit();
+  try {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    for (auto& site : reg.sites) {
+      if (std::strcmp(site.name, name) == 0) {
+        return &site;
+      }
+    }
+    reg.sites.emplace_back().name = name;
+    return &reg.sites.back();
+  } catch (...) {
+    return &g_unregistered;
+  }
+}
+
+Scope::Scope(Site* site) noexcept
+  : site_(site) {
+  start_[kAllocs] = t_allocs;
+  start_[kAllocBytes] = t_alloc_bytes;
+  read_hw(start_);
+}
+
+Scope::~Scope() {
+  std::uint64_t stop[kCounters] = {};
+  read_hw(stop);
+  stop[kAllocs] = t_allocs;
+  stop[kAllocBytes] = t_alloc_bytes;
+  site_->calls.fetch_add(1, std::memory_order_relaxed);
+  for (std::int32_t i = 0; i < kCounters; ++i) {
+    site_->totals[i].fetch_add(stop[i] - start_[i], std::memory_order_relaxed);
+  }
+}
+
+std::ostream& Dump(std::ostream& ostrm, const Format fmt) {
+  Registry& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mtx);
+  std::vector<const Site*> sites;
+  for (const auto& site : reg.sites) {
+    sites.push_back(&site);
+  }
+  if (0 < g_unregistered.calls.load()) {
+    sites.push_back(&g_unregistered);
+  }
+  const std::uint32_t missing = g_hw_missing.load();
+  std::vector<std::int32_t> columns;
+  for (std::int32_t i = 0; i < kCounters; ++i) {
+    if (kHwCounters <= i || ((missing >> i) & 1) == 0) {
+      columns.push_back(i);
+    }
+  }
+  if (fmt == Format::Json) {
+    ostrm << "{\n  \"perf\": " << (missing != kAllHwMissing ? "true" : "false") << ",\n  \"unavailable\": [";
+    bool comma = false;
+    for (std::int32_t i = 0; i < kHwCounters; ++i) {
+      if ((missing >> i) & 1) {
+        ostrm << (comma ? ", \"" : "\"") << kColumns[i] << '"';
+        comma = true;
+      }
+    }
+    ostrm << "],\n  \"sites\": [";
+    comma = false;
+    for (const Site* site : sites) {
+      ostrm << (comma ? ",\n" : "\n") << "    {\"name\": \"" << site->name
+        << "\", \"calls\": " << site->calls.load();
+      for (const std::int32_t i : columns) {
+        ostrm << ", \"" << kColumns[i] << "\": " << site->totals[i].load();
+      }
+      ostrm << "}";
+      comma = true;
+    }
+    ostrm << "\n  ]\n}\n";
+    return ostrm;
+  }
+  if (missing == kAllHwMissing) {
+    ostrm << "instr: hardware counters unavailable (perf_event_open failed)\n";
+  } else if (missing != 0) {
+    ostrm << "instr: unavailable counters omitted:";
+    for (std::int32_t i = 0; i < kHwCounters; ++i) {
+      if ((missing >> i) & 1) {
+        ostrm << ' ' << kColumns[i];
+      }
+    }
+    ostrm << '\n';
+  }
+  ostrm << std::left << std::setw(28) << "site" << std::right << std::setw(12) << "calls";
+  for (const std::int32_t i : columns) {
+    ostrm << std::setw(15) << kColumns[i];
+  }
+  ostrm << '\n';
+  for (const Site* site : sites) {
+    ostrm << std::left << std::setw(28) << site->name << std::right << std::setw(12) << site->calls.load();
+    for (const std::int32_t i : columns) {
+      ostrm << std::setw(15) << site->totals[i].load();
+    }
+    ostrm << '\n';
+  }
+  return ostrm;
+}
+
+}
+
+// Allocation counting. Only linked in when the instrumentation is enabled.
+// All replaceable forms are covered, including the align_val_t ones used for
+// over-aligned types, so allocs/alloc_bytes see every operator new.
+
+namespace {
+
+void* raw_alloc(const std::size_t size, const std::size_t align) noexcept {
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    return std::malloc(size);
+  }
+#if defined(_WIN32)
+  return _aligned_malloc(size, align);
+#else
+  void* ptr = nullptr;
+  return posix_memalign(&ptr, align, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void raw_free(void* ptr, const std::size_t align) noexcept {
+#if defined(_WIN32)
+  if (__STDCPP_DEFAULT_NEW_ALIGNMENT__ < align) {
+    _aligned_free(ptr);
+    return;
+  }
+#endif
+  static_cast<void>(align);
+  std::free(ptr);
+}
+
+//! Same contract as the default operator new: retry through the new handler
+//! until it frees memory, throws, or is not installed.
+void* counted_alloc(const std::size_t size, const std::size_t align) {
+  ++t_allocs;
+  t_alloc_bytes += size;
+  while (true) {
+    if (void* ptr = raw_alloc(size == 0 ? 1 : size, align)) {
+      return ptr;
+    }
+    const std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+void* counted_alloc_nothrow(const std::size_t size, const std::size_t align) noexcept {
+  try {
+    return counted_alloc(size, align);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+constexpr std::size_t kDefaultAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+}
+
+void* operator new(std::size_t size) {
+  return counted_alloc(size, kDefaultAlign);
+}
+
+void* operator new[](std::size_t size) {
+  return counted_alloc(size, kDefaultAlign);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_alloc_nothrow(size, kDefaultAlign);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_alloc_nothrow(size, kDefaultAlign);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+  return counted_alloc(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+  return counted_alloc(size, static_cast<std::size_t>(align));
+}
+
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return counted_alloc_nothrow(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+  return counted_alloc_nothrow(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t align) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* ptr, std::align_val_t align) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t align) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t align) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+  raw_free(ptr, static_cast<std::size_t>(align));
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef INSTR_INSTR_HPP_20261019
+#define INSTR_INSTR_HPP_20261019
+
+//! Opt-in hardware counter instrumentation of lab hot paths.
+//!
+//! Configure with -DLABS_INSTRUMENT=ON to enable; otherwise LABS_INSTR_SCOPE
+//! expands to nothing and no code from this header is used.
+//! Every scope adds cycles, instructions, L1D/LLC misses, branch misses
+//! (perf_event_open, Linux only) and heap allocations (every operator new
+//! form, over-aligned ones included) made in it to its call site.
+//! Scopes are inclusive: a nested scope is also counted in the outer one.
+//! The table is written at exit to $LABS_INSTR_OUT (stderr by default) as
+//! text, or as JSON when LABS_INSTR_FORMAT=json.
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+namespace instr {
+
+enum Counter : std::int32_t {
+  kCycles = 0,
+  kInstructions,
+  kL1dMisses,
+  kLlcMisses,
+  kBranchMisses,
+  kAllocs,
+  kAllocBytes,
+  kCounters
+};
+
+//! Totals of one instrumented call site.
+struct Site {
+  const char* name = nullptr;
+  std::atomic<std::uint64_t> calls{ 0 };
+  std::atomic<std::uint64_t> totals[kCounters] = {};
+};
+
+//! Returns the site registered under name (created on first use, never freed).
+//! Never throws: if registration fails the call is counted in a shared
+//! "(unregistered)" site, so scopes can sit in noexcept functions.
+Site* Register(const char* name) noexcept;
+
+//! Counts everything between construction and destruction into site.
+class Scope {
+public:
+  explicit Scope(Site* site) noexcept;
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+  ~Scope();
+
+private:
+  Site* site_ = nullptr;
+  std::uint64_t start_[kCounters] = {};
+};
+
+enum class Format { Text, Json };
+
+//! Writes all sites; columns of hardware counters that failed to open in any
+//! thread are left out and listed as unavailable.
+std::ostream& Dump(std::ostream& ostrm, const Format fmt);
+
+}
+
+#if defined(LABS_INSTRUMENT)
+#define LABS_INSTR_CONCAT_(a, b) a##b
+#define LABS_INSTR_CONCAT(a, b) LABS_INSTR_CONCAT_(a, b)
+#define LABS_INSTR_SCOPE(name) \
+  static ::instr::Site* const LABS_INSTR_CONCAT(instr_site_, __LINE__) = ::instr::Register(name); \
+  const ::instr::Scope LABS_INSTR_CONCAT(instr_scope_, __LINE__)(LABS_INSTR_CONCAT(instr_site_, __LINE__))
+#else
+#define LABS_INSTR_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif
@@ -1,6 +1,78 @@
 #include "rational/rational.hpp"
+#include <instr/instr.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <exception>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+//! a * b < c * d for a, c < 2^64 and b, d < 2^32, in 96-bit arithmetic.
+bool MulLess(const std::uint64_t a, const std::uint64_t b,
+    const std::uint64_t c, const std::uint64_t d) noexcept {
+    const auto wide = [](const std::uint64_t x, const std::uint64_t y) {
+        const std::uint64_t lo = (x & 0xFFFFFFFFu) * y;
+        const std::uint64_t mid = (x >> 32) * y;
+        const std::uint64_t low = lo + (mid << 32);
+        return std::pair{ (mid >> 32) + (low < lo ? 1u : 0u), low };
+    };
+    return wide(a, b) < wide(c, d);
+}
+
+//! Convergents h/k of a continued fraction fed one partial quotient at a
+//! time, stopping at the best approximation with h <= max_num, k <= max_den.
+class BestApprox {
+public:
+    BestApprox(const std::uint64_t max_num, const std::uint64_t max_den) noexcept
+        : max_num_(max_num)
+        , max_den_(max_den) {
+    }
+
+    [[nodiscard]] bool done() const noexcept { return done_; }
+    [[nodiscard]] std::uint64_t num() const noexcept { return h_; }
+    [[nodiscard]] std::uint64_t den() const noexcept { return k_; }
+
+    //! Feeds a_n of the complete quotient x_n = a + rem / div (rem == 0 ends).
+    void push(const std::uint64_t a, const std::uint64_t rem, const std::uint64_t div) noexcept {
+        // h, k < 2^31, so for a < 2^32 the next convergent cannot wrap and
+        // the common case needs no division.
+        if (a < (std::uint64_t(1) << 32)
+            && a * h_ + h_prev_ <= max_num_ && a * k_ + k_prev_ <= max_den_) {
+            Advance(a);
+            done_ = rem == 0;
+            return;
+        }
+        const std::uint64_t none = std::numeric_limits<std::uint64_t>::max();
+        const std::uint64_t t = std::min(h_ == 0 ? none : (max_num_ - h_prev_) / h_,
+            k_ == 0 ? none : (max_den_ - k_prev_) / k_);
+        // The semiconvergent (t h + h') / (t k + k') beats h / k iff
+        // x_n < 2t + k'/k; with a == 2t that is rem * k < k' * div.
+        if (a < 2 * t || (a == 2 * t && MulLess(rem, k_, div, k_prev_))) {
+            Advance(t);
+        }
+        done_ = true;
+    }
+
+private:
+    std::uint64_t max_num_ = 0;
+    std::uint64_t max_den_ = 0;
+    std::uint64_t h_prev_ = 0;
+    std::uint64_t k_prev_ = 1;
+    std::uint64_t h_ = 1;
+    std::uint64_t k_ = 0;
+    bool done_ = false;
+
+    void Advance(const std::uint64_t a) noexcept {
+        h_prev_ = std::exchange(h_, a * h_ + h_prev_);
+        k_prev_ = std::exchange(k_, a * k_ + k_prev_);
+    }
+};
+
+}
 
 Rational::Rational(const std::int32_t num, const std::int32_t den)
     : num_(num)
@@ -12,6 +84,7 @@ Rational::Rational(const std::int32_t num, const std::int32_t den)
 }
 
 void Rational::Normalize() noexcept {
+    LABS_INSTR_SCOPE("Rational::Normalize");
     if (den_ < 0) {
         den_ = -den_;
         num_ = -num_;
@@ -27,32 +100,148 @@ void Rational::Normalize() noexcept {
     den_ /= g;
 }
 
-bool Rational::operator==(const Rational& rhs) const noexcept {
-    return (num_ == rhs.num_) && (den_ == rhs.den_);
+Rational Rational::Unchecked(const std::int32_t num, const std::int32_t den) noexcept {
+    Rational res;
+    res.num_ = num;
+    res.den_ = den;
+    return res;
 }
 
-bool Rational::operator!=(const Rational& rhs) const noexcept {
-    return !operator==(rhs);
-}
+Rational Rational::from_double(const double x, const std::int32_t max_den) {
+    LABS_INSTR_SCOPE("Rational::from_double");
+    if (std::isnan(x)) {
+        throw std::invalid_argument("NaN in Rational::from_double");
+    }
+    if (max_den < 1) {
+        throw std::invalid_argument("Non-positive max_den in Rational::from_double");
+    }
+    constexpr std::int32_t max_num = std::numeric_limits<std::int32_t>::max();
+    const double ax = std::abs(x);
+    if (!(ax <= max_num)) {
+        throw std::overflow_error("Value out of range in Rational::from_double");
+    }
+    if (ax == 0.0) {
+        return Rational();
+    }
+
+    // ax = mant / 2^shift exactly, with mant odd (or shift == 0).
+    int exp = 0;
+    std::uint64_t mant = static_cast<std::uint64_t>(std::ldexp(std::frexp(ax, &exp), 53));
+    int shift = 53 - exp;
+    const int zeros = std::min(std::countr_zero(mant), shift);
+    mant >>= zeros;
+    shift -= zeros;
+
+    BestApprox best(max_num, static_cast<std::uint64_t>(max_den));
+    std::uint64_t lhs = mant;
+    std::uint64_t rhs = std::uint64_t(1) << std::min(shift, 63);
+    if (63 < shift) {
+        // 2^shift does not fit: a0 = 0 and a1 = 2^shift / mant is taken by
+        // long division. a1 >= 2^(shift - width) >= 2^32 is more than twice
+        // any max_den, so the result is 0; otherwise a1 < 2^33 and mant > 1.
+        best.push(0, mant, 0);
+        if (32 <= shift - std::bit_width(mant)) {
+            best.push(std::uint64_t(1) << 62, 1, mant);
+        } else {
+            std::uint64_t quot = 0;
+            std::uint64_t rem = 1;
+            for (int i = 0; i < shift; ++i) {
+                quot <<= 1;
+                rem <<= 1;
+                if (mant <= rem) {
+                    rem -= mant;
+                    quot |= 1;
+                }
+            }
+            best.push(quot, rem, mant);
+            lhs = mant;
+            rhs = rem;
+        }
+    }
+    while (!best.done()) {
+        const std::uint64_t quot = lhs / rhs;
+        const std::uint64_t rem = lhs % rhs;
+        best.push(quot, rem, rhs);
+        lhs = std::exchange(rhs, rem);
+    }
 
-bool Rational::operator<(const Rational& rhs) const noexcept {
-    return static_cast<std::int64_t>(num_) * rhs.den_ <
-        static_cast<std::int64_t>(rhs.num_) * den_;
+    const auto num = static_cast<std::int32_t>(best.num());
+    return Unchecked(x < 0.0 ? -num : num, static_cast<std::int32_t>(best.den()));
 }
 
-bool Rational::operator<=(const Rational& rhs) const noexcept {
-    return static_cast<std::int64_t>(num_) * rhs.den_ <=
-        static_cast<std::int64_t>(rhs.num_) * den_;
+void Rational::from_double(std::span<const double> src, std::span<Rational> dst, const std::int32_t max_den) {
+    if (src.size() != dst.size()) {
+        throw std::invalid_argument("Size mismatch in Rational::from_double");
+    }
+    // Below this a chunk costs less than starting its thread.
+    constexpr std::size_t min_chunk = 16384;
+    const std::size_t chunks = std::clamp<std::size_t>(src.size() / min_chunk,
+        1, std::max(1u, std::thread::hardware_concurrency()));
+    const auto bound = [&](const std::size_t chunk) { return src.size() * chunk / chunks; };
+
+    std::vector<std::exception_ptr> errors(chunks);
+    const auto convert = [&](const std::size_t chunk) {
+        try {
+            for (std::size_t i = bound(chunk); i < bound(chunk + 1); ++i) {
+                dst[i] = from_double(src[i], max_den);
+            }
+        }
+        catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(chunks - 1);
+        for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+            workers.emplace_back(convert, chunk);
+        }
+        convert(0);
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
 }
 
-bool Rational::operator>(const Rational& rhs) const noexcept {
-    return static_cast<std::int64_t>(num_) * rhs.den_ >
-        static_cast<std::int64_t>(rhs.num_) * den_;
+std::vector<std::int32_t> Rational::continued_fraction() const {
+    std::vector<std::int32_t> terms;
+    std::int64_t lhs = num_;
+    std::int64_t rhs = den_;
+    std::int64_t quot = lhs / rhs - (lhs % rhs < 0 ? 1 : 0);
+    while (true) {
+        terms.push_back(static_cast<std::int32_t>(quot));
+        const std::int64_t rem = lhs - quot * rhs;
+        if (rem == 0) {
+            return terms;
+        }
+        lhs = std::exchange(rhs, rem);
+        quot = lhs / rhs;
+    }
 }
 
-bool Rational::operator>=(const Rational& rhs) const noexcept {
-    return static_cast<std::int64_t>(num_) * rhs.den_ >=
-        static_cast<std::int64_t>(rhs.num_) * den_;
+Rational Rational::from_continued_fraction(std::span<const std::int32_t> terms) {
+    if (terms.empty()) {
+        throw std::invalid_argument("Empty continued fraction");
+    }
+    constexpr std::int64_t max_num = std::numeric_limits<std::int32_t>::max();
+    std::int64_t h_prev = 1;
+    std::int64_t k_prev = 0;
+    std::int64_t h = terms[0];
+    std::int64_t k = 1;
+    for (std::size_t i = 1; i < terms.size(); ++i) {
+        if (terms[i] <= 0) {
+            throw std::invalid_argument("Non-positive partial quotient in continued fraction");
+        }
+        h_prev = std::exchange(h, terms[i] * h + h_prev);
+        k_prev = std::exchange(k, terms[i] * k + k_prev);
+        if (max_num < std::abs(h) || max_num < k) {
+            throw std::overflow_error("Continued fraction out of Rational range");
+        }
+    }
+    // Consecutive convergents are coprime (h k' - h' k = +-1).
+    return Unchecked(static_cast<std::int32_t>(h), static_cast<std::int32_t>(k));
 }
 
 Rational& Rational::operator+=(const Rational& rhs) noexcept {
@@ -122,6 +311,7 @@ Rational& Rational::operator/=(const std::int32_t rhs) {
 }
 
 std::istream& Rational::ReadFrom(std::istream& istrm) {
+    LABS_INSTR_SCOPE("Rational::ReadFrom");
     
     std::istream::sentry sentry(istrm);
     if (!sentry) {
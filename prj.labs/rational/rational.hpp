@@ -1,9 +1,15 @@
 #ifndef RATIONAL_RATIONAL_HPP
 #define RATIONAL_RATIONAL_HPP
 
+#include <compare>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <iosfwd>
+#include <limits>
+#include <span>
+#include <vector>
 
 class Rational {
 public:
@@ -18,15 +24,37 @@ public:
     [[nodiscard]] std::int32_t num() const noexcept { return num_; }
     [[nodiscard]] std::int32_t den() const noexcept { return den_; }
 
-    [[nodiscard]] bool operator==(const Rational& rhs) const noexcept;
-    [[nodiscard]] bool operator!=(const Rational& rhs) const noexcept;
-    [[nodiscard]] bool operator<(const Rational& rhs) const noexcept;
-    [[nodiscard]] bool operator<=(const Rational& rhs) const noexcept;
-    [[nodiscard]] bool operator>(const Rational& rhs) const noexcept;
-    [[nodiscard]] bool operator>=(const Rational& rhs) const noexcept;
+    //! num_/den_ are always normalized, so equal values have equal fields.
+    [[nodiscard]] bool operator==(const Rational& rhs) const noexcept {
+        return num_ == rhs.num_ && den_ == rhs.den_;
+    }
+    //! Single 64-bit cross-multiply; den_ > 0 so the sign is preserved.
+    [[nodiscard]] std::strong_ordering operator<=>(const Rational& rhs) const noexcept {
+        return static_cast<std::int64_t>(num_) * rhs.den_ <=> static_cast<std::int64_t>(rhs.num_) * den_;
+    }
 
     [[nodiscard]] Rational operator-() const noexcept { return { -num_, den_ }; }
 
+    //! Closest value to x with den <= max_den (ties go to the smaller den),
+    //! found on the continued fraction of x with exact integer arithmetic.
+    //! Throws std::invalid_argument for nan or max_den < 1 and
+    //! std::overflow_error if |x| is outside the int32 range.
+    [[nodiscard]] static Rational from_double(const double x,
+        const std::int32_t max_den = std::numeric_limits<std::int32_t>::max());
+
+    //! Converts src into dst (same size) on several threads; on error rethrows
+    //! the exception of the first failing element, dst is then partly filled.
+    static void from_double(std::span<const double> src, std::span<Rational> dst,
+        const std::int32_t max_den = std::numeric_limits<std::int32_t>::max());
+
+    //! Partial quotients [a0; a1, ..., an]: a0 = floor(num/den), ai > 0.
+    [[nodiscard]] std::vector<std::int32_t> continued_fraction() const;
+
+    //! Inverse of continued_fraction(). Throws std::invalid_argument for an
+    //! empty span or ai <= 0 (i > 0) and std::overflow_error if a convergent
+    //! leaves the int32 range.
+    [[nodiscard]] static Rational from_continued_fraction(std::span<const std::int32_t> terms);
+
     Rational& operator+=(const Rational& rhs) noexcept;
     Rational& operator-=(const Rational& rhs) noexcept;
     Rational& operator*=(const Rational& rhs) noexcept;
@@ -51,6 +79,9 @@ private:
     std::int32_t den_ = 1; 
 
     void Normalize() noexcept;
+
+    //! num/den already coprime with den > 0: skips the gcd.
+    [[nodiscard]] static Rational Unchecked(const std::int32_t num, const std::int32_t den) noexcept;
 };
 
 [[nodiscard]] Rational operator+(const Rational& lhs, const Rational& rhs) noexcept;
@@ -71,4 +102,19 @@ private:
 std::ostream& operator<<(std::ostream& ostrm, const Rational& rhs) noexcept;
 std::istream& operator>>(std::istream& istrm, Rational& rhs) ;
 
+//! Mixes the normalized num/den pair (murmur3 finalizer).
+template<>
+struct std::hash<Rational> {
+    [[nodiscard]] std::size_t operator()(const Rational& rhs) const noexcept {
+        std::uint64_t x = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(rhs.num())) << 32)
+            | static_cast<std::uint32_t>(rhs.den());
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<std::size_t>(x);
+    }
+};
+
 #endif
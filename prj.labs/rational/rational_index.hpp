@@ -0,0 +1,120 @@
+#ifndef RATIONAL_RATIONAL_INDEX_HPP
+#define RATIONAL_RATIONAL_INDEX_HPP
+
+#include "rational/rational.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//! Sorted flat index with Rational keys.
+//!
+//! Keys and values live in two parallel sorted arrays: lookups are a
+//! branchless binary search over the keys only, ordered ranges are index
+//! intervals. Bulk assign() is O(n log n); single insert/erase are O(n).
+template<class V>
+class RationalIndex {
+public:
+    RationalIndex() = default;
+    RationalIndex(const RationalIndex&) = default;
+    RationalIndex(RationalIndex&&) noexcept = default;
+    ~RationalIndex() = default;
+    RationalIndex& operator=(const RationalIndex&) = default;
+    RationalIndex& operator=(RationalIndex&&) noexcept = default;
+
+    //! Replaces the contents; for equal keys the first entry wins.
+    void assign(std::vector<std::pair<Rational, V>> entries);
+
+    //! Returns false (and leaves the value) if key is already present.
+    bool insert(const Rational& key, const V& val);
+    bool erase(const Rational& key);
+
+    [[nodiscard]] std::ptrdiff_t size() const noexcept { return static_cast<std::ptrdiff_t>(keys_.size()); }
+    [[nodiscard]] bool empty() const noexcept { return keys_.empty(); }
+
+    //! Position of the first key not less than key (size() if none).
+    [[nodiscard]] std::ptrdiff_t lower_bound(const Rational& key) const noexcept;
+    //! Position of the first key greater than key (size() if none).
+    [[nodiscard]] std::ptrdiff_t upper_bound(const Rational& key) const noexcept;
+
+    [[nodiscard]] const V* find(const Rational& key) const noexcept;
+    [[nodiscard]] bool contains(const Rational& key) const noexcept { return find(key) != nullptr; }
+
+    [[nodiscard]] const Rational& key(const std::ptrdiff_t idx) const { return keys_.at(idx); }
+    [[nodiscard]] const V& value(const std::ptrdiff_t idx) const { return vals_.at(idx); }
+    [[nodiscard]] V& value(const std::ptrdiff_t idx) { return vals_.at(idx); }
+
+private:
+    std::vector<Rational> keys_;
+    std::vector<V> vals_;
+};
+
+template<class V>
+void RationalIndex<V>::assign(std::vector<std::pair<Rational, V>> entries) {
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    keys_.clear();
+    vals_.clear();
+    keys_.reserve(entries.size());
+    vals_.reserve(entries.size());
+    for (auto& [key, val] : entries) {
+        if (keys_.empty() || keys_.back() != key) {
+            keys_.push_back(key);
+            vals_.push_back(std::move(val));
+        }
+    }
+}
+
+template<class V>
+std::ptrdiff_t RationalIndex<V>::lower_bound(const Rational& key) const noexcept {
+    // Halving search with a conditional move instead of a branch per level.
+    const Rational* base = keys_.data();
+    std::ptrdiff_t len = size();
+    if (len == 0) {
+        return 0;
+    }
+    while (1 < len) {
+        const std::ptrdiff_t half = len / 2;
+        base = base[half - 1] < key ? base + half : base;
+        len -= half;
+    }
+    return (base - keys_.data()) + (*base < key ? 1 : 0);
+}
+
+template<class V>
+std::ptrdiff_t RationalIndex<V>::upper_bound(const Rational& key) const noexcept {
+    const std::ptrdiff_t pos = lower_bound(key);
+    return pos < size() && keys_[pos] == key ? pos + 1 : pos;
+}
+
+template<class V>
+const V* RationalIndex<V>::find(const Rational& key) const noexcept {
+    const std::ptrdiff_t pos = lower_bound(key);
+    return pos < size() && keys_[pos] == key ? &vals_[pos] : nullptr;
+}
+
+template<class V>
+bool RationalIndex<V>::insert(const Rational& key, const V& val) {
+    const std::ptrdiff_t pos = lower_bound(key);
+    if (pos < size() && keys_[pos] == key) {
+        return false;
+    }
+    keys_.insert(keys_.begin() + pos, key);
+    vals_.insert(vals_.begin() + pos, val);
+    return true;
+}
+
+template<class V>
+bool RationalIndex<V>::erase(const Rational& key) {
+    const std::ptrdiff_t pos = lower_bound(key);
+    if (pos == size() || keys_[pos] != key) {
+        return false;
+    }
+    keys_.erase(keys_.begin() + pos);
+    vals_.erase(vals_.begin() + pos);
+    return true;
+}
+
+#endif
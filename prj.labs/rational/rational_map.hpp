@@ -0,0 +1,249 @@
+#ifndef RATIONAL_RATIONAL_MAP_HPP
+#define RATIONAL_RATIONAL_MAP_HPP
+
+#include "rational/rational.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RATIONAL_MAP_SSE2 1
+#endif
+
+//! Open-addressing hash map with Rational keys.
+//!
+//! Slots are grouped by 16; every slot has a control byte holding 7 bits of
+//! the hash (or empty/deleted), so one SSE2 compare checks a whole group and
+//! keys are only touched on a tag match. Groups are probed triangularly.
+//! V must be default constructible; pointers returned by find() are
+//! invalidated by insertion.
+template<class V>
+class RationalMap {
+public:
+    RationalMap() = default;
+    RationalMap(const RationalMap&) = default;
+    RationalMap(RationalMap&&) noexcept = default;
+    ~RationalMap() = default;
+    RationalMap& operator=(const RationalMap&) = default;
+    RationalMap& operator=(RationalMap&&) noexcept = default;
+
+    [[nodiscard]] std::ptrdiff_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    void clear() noexcept;
+
+    //! Makes room for count elements without rehashing.
+    void reserve(const std::ptrdiff_t count);
+
+    //! Returns false (and leaves the value) if key is already present.
+    bool insert(const Rational& key, const V& val);
+
+    [[nodiscard]] V& operator[](const Rational& key);
+
+    [[nodiscard]] V* find(const Rational& key) noexcept;
+    [[nodiscard]] const V* find(const Rational& key) const noexcept;
+    [[nodiscard]] bool contains(const Rational& key) const noexcept { return find(key) != nullptr; }
+
+    bool erase(const Rational& key);
+
+private:
+    static constexpr std::ptrdiff_t kGroup = 16;
+    static constexpr std::int8_t kEmpty = -128;   // 0b10000000
+    static constexpr std::int8_t kDeleted = -2;   // 0b11111110
+
+    std::vector<std::int8_t> ctrl_;
+    std::vector<Rational> keys_;
+    std::vector<V> vals_;
+    std::ptrdiff_t size_ = 0;
+    std::ptrdiff_t growth_left_ = 0;   // free slots before the next rehash
+
+    [[nodiscard]] std::ptrdiff_t groups() const noexcept {
+        return static_cast<std::ptrdiff_t>(ctrl_.size()) / kGroup;
+    }
+
+    //! Bit i set when ctrl[i] == tag.
+    static std::uint32_t match(const std::int8_t* ctrl, const std::int8_t tag) noexcept;
+    //! Bit i set when ctrl[i] is empty or deleted.
+    static std::uint32_t match_free(const std::int8_t* ctrl) noexcept;
+
+    [[nodiscard]] std::ptrdiff_t find_slot(const Rational& key, const std::size_t hash) const noexcept;
+    [[nodiscard]] std::ptrdiff_t free_slot(const std::size_t hash) const noexcept;
+    void rehash(const std::ptrdiff_t groups);
+    std::ptrdiff_t insert_slot(const Rational& key);
+};
+
+template<class V>
+std::uint32_t RationalMap<V>::match(const std::int8_t* ctrl, const std::int8_t tag) noexcept {
+#if defined(RATIONAL_MAP_SSE2)
+    const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+#else
+    std::uint32_t bits = 0;
+    for (std::ptrdiff_t i = 0; i < kGroup; ++i) {
+        bits |= static_cast<std::uint32_t>(ctrl[i] == tag) << i;
+    }
+    return bits;
+#endif
+}
+
+template<class V>
+std::uint32_t RationalMap<V>::match_free(const std::int8_t* ctrl) noexcept {
+#if defined(RATIONAL_MAP_SSE2)
+    // Full slots hold a tag in [0, 127]; empty and deleted have the sign bit.
+    const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(group));
+#else
+    std::uint32_t bits = 0;
+    for (std::ptrdiff_t i = 0; i < kGroup; ++i) {
+        bits |= static_cast<std::uint32_t>(ctrl[i] < 0) << i;
+    }
+    return bits;
+#endif
+}
+
+template<class V>
+std::ptrdiff_t RationalMap<V>::find_slot(const Rational& key, const std::size_t hash) const noexcept {
+    if (ctrl_.empty()) {
+        return -1;
+    }
+    const auto tag = static_cast<std::int8_t>(hash & 0x7F);
+    const std::ptrdiff_t mask = groups() - 1;
+    std::ptrdiff_t group = static_cast<std::ptrdiff_t>(hash >> 7) & mask;
+    for (std::ptrdiff_t step = 1; step <= groups(); ++step) {
+        const std::int8_t* ctrl = ctrl_.data() + group * kGroup;
+        for (std::uint32_t bits = match(ctrl, tag); bits != 0; bits &= bits - 1) {
+            const std::ptrdiff_t slot = group * kGroup + std::countr_zero(bits);
+            if (keys_[slot] == key) {
+                return slot;
+            }
+        }
+        if (match(ctrl, kEmpty) != 0) {
+            return -1;
+        }
+        group = (group + step) & mask;
+    }
+    return -1;
+}
+
+template<class V>
+std::ptrdiff_t RationalMap<V>::free_slot(const std::size_t hash) const noexcept {
+    const std::ptrdiff_t mask = groups() - 1;
+    std::ptrdiff_t group = static_cast<std::ptrdiff_t>(hash >> 7) & mask;
+    for (std::ptrdiff_t step = 1;; ++step) {
+        const std::uint32_t bits = match_free(ctrl_.data() + group * kGroup);
+        if (bits != 0) {
+            return group * kGroup + std::countr_zero(bits);
+        }
+        group = (group + step) & mask;
+    }
+}
+
+template<class V>
+void RationalMap<V>::rehash(const std::ptrdiff_t groups) {
+    std::vector<std::int8_t> ctrl(groups * kGroup, kEmpty);
+    std::vector<Rational> keys(groups * kGroup);
+    std::vector<V> vals(groups * kGroup);
+    std::swap(ctrl, ctrl_);
+    std::swap(keys, keys_);
+    std::swap(vals, vals_);
+    growth_left_ = groups * kGroup * 7 / 8 - size_;
+    const std::hash<Rational> hasher;
+    for (std::size_t i = 0; i < ctrl.size(); ++i) {
+        if (0 <= ctrl[i]) {
+            const std::size_t hash = hasher(keys[i]);
+            const std::ptrdiff_t slot = free_slot(hash);
+            ctrl_[slot] = static_cast<std::int8_t>(hash & 0x7F);
+            keys_[slot] = keys[i];
+            vals_[slot] = std::move(vals[i]);
+        }
+    }
+}
+
+template<class V>
+void RationalMap<V>::clear() noexcept {
+    ctrl_.clear();
+    keys_.clear();
+    vals_.clear();
+    size_ = 0;
+    growth_left_ = 0;
+}
+
+template<class V>
+void RationalMap<V>::reserve(const std::ptrdiff_t count) {
+    // growth_left_ already applies the 7/8 load factor (and tombstones).
+    if (count <= size_ + growth_left_) {
+        return;
+    }
+    const std::ptrdiff_t need = (std::max(count, size_) * 8 + 6) / 7;
+    rehash(static_cast<std::ptrdiff_t>(std::bit_ceil(static_cast<std::size_t>((need + kGroup - 1) / kGroup))));
+}
+
+template<class V>
+std::ptrdiff_t RationalMap<V>::insert_slot(const Rational& key) {
+    const std::size_t hash = std::hash<Rational>()(key);
+    const std::ptrdiff_t found = find_slot(key, hash);
+    if (0 <= found) {
+        return found;
+    }
+    if (growth_left_ == 0) {
+        // Mostly tombstones: rehash in place, otherwise double.
+        const std::ptrdiff_t cap = static_cast<std::ptrdiff_t>(ctrl_.size());
+        rehash(cap == 0 ? 1 : (size_ * 2 < cap * 7 / 8 ? groups() : groups() * 2));
+    }
+    const std::ptrdiff_t slot = free_slot(hash);
+    if (ctrl_[slot] == kEmpty) {
+        --growth_left_;
+    }
+    ctrl_[slot] = static_cast<std::int8_t>(hash & 0x7F);
+    keys_[slot] = key;
+    ++size_;
+    return -1 - slot;
+}
+
+template<class V>
+bool RationalMap<V>::insert(const Rational& key, const V& val) {
+    const std::ptrdiff_t slot = insert_slot(key);
+    if (0 <= slot) {
+        return false;
+    }
+    vals_[-1 - slot] = val;
+    return true;
+}
+
+template<class V>
+V& RationalMap<V>::operator[](const Rational& key) {
+    const std::ptrdiff_t slot = insert_slot(key);
+    return vals_[slot < 0 ? -1 - slot : slot];
+}
+
+template<class V>
+V* RationalMap<V>::find(const Rational& key) noexcept {
+    const std::ptrdiff_t slot = find_slot(key, std::hash<Rational>()(key));
+    return slot < 0 ? nullptr : &vals_[slot];
+}
+
+template<class V>
+const V* RationalMap<V>::find(const Rational& key) const noexcept {
+    const std::ptrdiff_t slot = find_slot(key, std::hash<Rational>()(key));
+    return slot < 0 ? nullptr : &vals_[slot];
+}
+
+template<class V>
+bool RationalMap<V>::erase(const Rational& key) {
+    const std::ptrdiff_t slot = find_slot(key, std::hash<Rational>()(key));
+    if (slot < 0) {
+        return false;
+    }
+    ctrl_[slot] = kDeleted;
+    vals_[slot] = V();
+    --size_;
+    return true;
+}
+
+#endif
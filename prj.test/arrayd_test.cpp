@@ -0,0 +1,132 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <arrayd/arrayd.hpp>
+#include <arrayd/arrayd_expr.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace {
+
+//! {first, first + step, ...} with size elements.
+ArrayD iota(const std::ptrdiff_t size, const float first, const float step) {
+  ArrayD arr(size);
+  for (std::ptrdiff_t i = 0; i < size; ++i) {
+    arr[i] = first + step * static_cast<float>(i);
+  }
+  return arr;
+}
+
+}
+
+TEST_CASE("arrayd - element-wise expressions") {
+  // 37 is not a multiple of the reduction lanes.
+  const ArrayD a = iota(37, 1.0f, 1.0f);
+  const ArrayD b = iota(37, 0.5f, -0.25f);
+  const ArrayD c = a * b + a / 2.0f - (-b);
+  REQUIRE(c.size() == a.size());
+  for (std::ptrdiff_t i = 0; i < c.size(); ++i) {
+    CHECK(c[i] == a[i] * b[i] + a[i] / 2.0f + b[i]);
+  }
+
+  ArrayD d;
+  d = a - b;
+  REQUIRE(d.size() == a.size());
+  CHECK(d[5] == a[5] - b[5]);
+}
+
+TEST_CASE("arrayd - scalar broadcast on both sides") {
+  const ArrayD a = iota(10, 1.0f, 2.0f);
+  const ArrayD left = 3.0f - a;
+  const ArrayD right = a - 3.0f;
+  const ArrayD div = 1.0f / a;
+  const ArrayD mul = 2 * a * 0.5;
+  for (std::ptrdiff_t i = 0; i < a.size(); ++i) {
+    CHECK(left[i] == 3.0f - a[i]);
+    CHECK(right[i] == a[i] - 3.0f);
+    CHECK(div[i] == 1.0f / a[i]);
+    CHECK(mul[i] == a[i]);
+  }
+  CHECK((1.0f + a).size() == a.size());
+  CHECK((2.0f * (a + 1.0f)).size() == a.size());
+}
+
+TEST_CASE("arrayd - assignment aliasing the target") {
+  ArrayD a = iota(20, 1.0f, 1.0f);
+  const ArrayD b = iota(20, 0.0f, 3.0f);
+  const ArrayD before(a);
+  const float* storage = a.data();
+  a = a * 2 - b;
+  CHECK(a.data() == storage);
+  for (std::ptrdiff_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i] == before[i] * 2 - b[i]);
+  }
+
+  a = b - a * a;
+  const ArrayD mid = before * 2 - b;
+  for (std::ptrdiff_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i] == b[i] - mid[i] * mid[i]);
+  }
+
+  a = -a;
+  for (std::ptrdiff_t i = 0; i < a.size(); ++i) {
+    CHECK(a[i] == -(b[i] - mid[i] * mid[i]));
+  }
+
+  // Assigning to a differently sized array resizes it.
+  ArrayD small = iota(3, 1.0f, 1.0f);
+  small = b + 1.0f;
+  REQUIRE(small.size() == b.size());
+  CHECK(small[19] == b[19] + 1.0f);
+}
+
+TEST_CASE("arrayd - size mismatch") {
+  const ArrayD a(4);
+  const ArrayD b(5);
+  CHECK_THROWS_AS((void)(a + b), std::invalid_argument);
+  CHECK_THROWS_AS((void)(a * 2.0f - b), std::invalid_argument);
+  CHECK_THROWS_AS((void)dot(a, b), std::invalid_argument);
+  CHECK_THROWS_AS((void)ArrayD(a + b), std::invalid_argument);
+
+  // A failed expression leaves the target untouched.
+  ArrayD c = iota(4, 1.0f, 1.0f);
+  CHECK_THROWS_AS(c = c + b, std::invalid_argument);
+  REQUIRE(c.size() == 4);
+  CHECK(c[3] == 4.0f);
+}
+
+TEST_CASE("arrayd - empty arrays") {
+  const ArrayD empty;
+  const ArrayD sum_expr = empty + empty * 2.0f;
+  CHECK(sum_expr.size() == 0);
+  CHECK(sum(empty) == 0.0f);
+  CHECK(dot(empty, empty) == 0.0f);
+  CHECK_THROWS_AS((void)min(empty), std::invalid_argument);
+  CHECK_THROWS_AS((void)max(empty - 1.0f), std::invalid_argument);
+  CHECK_THROWS_AS((void)(empty + ArrayD(1)), std::invalid_argument);
+
+  ArrayD shrunk = iota(8, 1.0f, 1.0f);
+  shrunk = empty * 3.0f;
+  CHECK(shrunk.size() == 0);
+}
+
+TEST_CASE("arrayd - reductions") {
+  const ArrayD a = iota(101, -50.0f, 1.0f);
+  CHECK(sum(a) == 0.0f);
+  CHECK(sum(a + 1.0f) == 101.0f);
+  CHECK(sum(2.0f * a - a) == 0.0f);
+  CHECK(min(a) == -50.0f);
+  CHECK(max(a) == 50.0f);
+  CHECK(min(-a) == -50.0f);
+  CHECK(max(a * a) == 2500.0f);
+  // 2 * (1^2 + ... + 50^2)
+  CHECK(dot(a, a) == 85850.0f);
+  CHECK(dot(a, a + 1.0f) == 85850.0f);
+
+  const ArrayD one = iota(1, 7.0f, 0.0f);
+  CHECK(sum(one) == 7.0f);
+  CHECK(min(one) == 7.0f);
+  CHECK(max(one) == 7.0f);
+  CHECK(dot(one, one) == 49.0f);
+}
@@ -0,0 +1,308 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <bitsetc/bitsetc.hpp>
+
+#include <cstring>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Kind = BitsetC::Kind;
+using Reference = std::set<std::uint32_t>;
+
+constexpr std::uint32_t kChunk = 0x10000;
+
+bool same(const BitsetC& bs, const Reference& ref, const std::uint32_t last) {
+  if (bs.count() != static_cast<std::int64_t>(ref.size())) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i <= last; ++i) {
+    if (bs.get(i) != (ref.count(i) != 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Chunk 0 filled so that optimize() leaves it in the given form.
+void fill(const Kind kind, const std::uint32_t seed, BitsetC& bs, Reference& ref) {
+  std::mt19937 gen(seed);
+  const auto add = [&](const std::uint32_t idx) {
+    bs.set(idx);
+    ref.insert(idx);
+  };
+  if (kind == Kind::Array) {
+    for (int i = 0; i < 500; ++i) {
+      add(gen() % kChunk);
+    }
+  } else if (kind == Kind::Bitmap) {
+    for (int i = 0; i < 30000; ++i) {
+      add(gen() % kChunk);
+    }
+  } else {
+    for (std::uint32_t start = seed * 97 % 1000; start < kChunk - 2000; start += 3000) {
+      bs.set_range(start, start + 1500);
+      for (std::uint32_t i = start; i <= start + 1500; ++i) {
+        ref.insert(i);
+      }
+    }
+  }
+  bs.optimize();
+}
+
+std::vector<unsigned char> image_of(const BitsetC& bs) {
+  std::vector<unsigned char> image(bs.serialized_size());
+  bs.WriteTo(image.data());
+  return image;
+}
+
+template<class T>
+void poke(std::vector<unsigned char>& image, const std::size_t at, const T val) {
+  std::memcpy(image.data() + at, &val, sizeof(T));
+}
+
+// Offsets inside the image (see BitsetC::WriteTo).
+constexpr std::size_t kDesc0 = 8;
+constexpr std::size_t kCard = 4;
+constexpr std::size_t kElements = 8;
+constexpr std::size_t kOffset = 12;
+
+}
+
+TEST_CASE("bitsetc - array grows into bitmap and shrinks back") {
+  BitsetC bs;
+  for (std::int32_t i = 0; i < BitsetC::kArrayMax; ++i) {
+    bs.set(static_cast<std::uint32_t>(i) * 2);
+  }
+  REQUIRE(bs.chunks() == 1);
+  CHECK(bs.chunk(0).kind == Kind::Array);
+  bs.set(1);
+  CHECK(bs.chunk(0).kind == Kind::Bitmap);
+  CHECK(bs.count() == BitsetC::kArrayMax + 1);
+  bs.set(1, false);
+  CHECK(bs.chunk(0).kind == Kind::Array);
+  CHECK(bs.count() == BitsetC::kArrayMax);
+  CHECK(bs.get(2));
+  CHECK_FALSE(bs.get(1));
+}
+
+TEST_CASE("bitsetc - run container follows single-bit edits") {
+  BitsetC bs;
+  bs.set_range(0, kChunk - 1);
+  REQUIRE(bs.chunks() == 1);
+  CHECK(bs.chunk(0).kind == Kind::Run);
+  CHECK(bs.count() == kChunk);
+
+  // Splitting the run bit by bit must not keep tens of thousands of runs.
+  for (std::uint32_t i = 0; i < kChunk; i += 2) {
+    bs.set(i, false);
+  }
+  CHECK(bs.chunk(0).kind == Kind::Bitmap);
+  CHECK(bs.count() == kChunk / 2);
+  CHECK(bs.bytes() < 16 * 1024);
+
+  // Down to array size the array form wins.
+  for (std::uint32_t i = 1; i < kChunk; i += 2) {
+    if (i % 64 != 1) {
+      bs.set(i, false);
+    }
+  }
+  CHECK(bs.chunk(0).kind == Kind::Array);
+  CHECK(bs.count() == kChunk / 64);
+
+  BitsetC runs;
+  runs.set_range(100, 200);
+  runs.set(201);
+  runs.set(99);
+  CHECK(runs.chunk(0).kind == Kind::Run);
+  CHECK(runs.count() == 103);
+  runs.set(150, false);
+  CHECK(runs.count() == 102);
+  CHECK_FALSE(runs.get(150));
+  CHECK(runs.get(149));
+  CHECK(runs.get(151));
+}
+
+TEST_CASE("bitsetc - optimize picks the smallest form") {
+  BitsetC bs;
+  Reference ref;
+  for (std::uint32_t i = 1000; i < 9000; ++i) {
+    bs.set(i);
+    ref.insert(i);
+  }
+  CHECK(bs.chunk(0).kind == Kind::Bitmap);
+  bs.optimize();
+  CHECK(bs.chunk(0).kind == Kind::Run);
+  CHECK(same(bs, ref, kChunk));
+
+  for (const Kind kind : { Kind::Array, Kind::Bitmap, Kind::Run }) {
+    BitsetC filled;
+    Reference expected;
+    fill(kind, 7, filled, expected);
+    REQUIRE(filled.chunks() == 1);
+    CHECK(filled.chunk(0).kind == kind);
+    CHECK(same(filled, expected, kChunk));
+  }
+}
+
+TEST_CASE("bitsetc - set_range spans chunks") {
+  BitsetC bs;
+  bs.set_range(kChunk - 10, 3 * kChunk + 9);
+  CHECK(bs.chunks() == 4);
+  CHECK(bs.count() == 2 * kChunk + 20);
+  CHECK_FALSE(bs.get(kChunk - 11));
+  CHECK(bs.get(kChunk - 10));
+  CHECK(bs.get(3 * kChunk + 9));
+  CHECK_FALSE(bs.get(3 * kChunk + 10));
+  CHECK_THROWS_AS(bs.set_range(10, 9), std::invalid_argument);
+}
+
+TEST_CASE("bitsetc - and / or for every container pair") {
+  for (const Kind lhs_kind : { Kind::Array, Kind::Bitmap, Kind::Run }) {
+    for (const Kind rhs_kind : { Kind::Array, Kind::Bitmap, Kind::Run }) {
+      BitsetC lhs;
+      BitsetC rhs;
+      Reference lhs_ref;
+      Reference rhs_ref;
+      fill(lhs_kind, 1, lhs, lhs_ref);
+      fill(rhs_kind, 2, rhs, rhs_ref);
+      // Chunks present on one side only.
+      lhs.set(5 * kChunk + 3);
+      lhs_ref.insert(5 * kChunk + 3);
+      rhs.set(7 * kChunk + 4);
+      rhs_ref.insert(7 * kChunk + 4);
+
+      Reference both;
+      Reference either(lhs_ref);
+      for (const auto idx : rhs_ref) {
+        if (lhs_ref.count(idx) != 0) {
+          both.insert(idx);
+        }
+        either.insert(idx);
+      }
+      CHECK(same(lhs & rhs, both, 8 * kChunk));
+      CHECK(same(lhs | rhs, either, 8 * kChunk));
+      CHECK(same(rhs & lhs, both, 8 * kChunk));
+      CHECK(same(rhs | lhs, either, 8 * kChunk));
+      CHECK((lhs & lhs) == lhs);
+      CHECK((lhs | lhs) == lhs);
+    }
+  }
+  BitsetC some;
+  some.set(42);
+  CHECK((some & BitsetC()).empty());
+  CHECK((some | BitsetC()) == some);
+}
+
+TEST_CASE("bitsetc - image round trips") {
+  BitsetC bs;
+  Reference ref;
+  fill(Kind::Array, 3, bs, ref);
+  BitsetC bitmap;
+  Reference bitmap_ref;
+  fill(Kind::Bitmap, 4, bitmap, bitmap_ref);
+  BitsetC runs;
+  Reference runs_ref;
+  fill(Kind::Run, 5, runs, runs_ref);
+  for (const auto idx : bitmap_ref) {
+    bs.set(idx + 2 * kChunk);
+  }
+  for (const auto idx : runs_ref) {
+    bs.set(idx + 9 * kChunk);
+  }
+  bs.optimize();
+  REQUIRE(bs.chunks() == 3);
+
+  const std::vector<unsigned char> image = image_of(bs);
+  CHECK(BitsetC::FromImage(image.data(), image.size()) == bs);
+
+  std::stringstream strm;
+  bs.WriteTo(strm);
+  BitsetC read;
+  read.ReadFrom(strm);
+  CHECK(strm.good());
+  CHECK(read == bs);
+
+  const BitsetCView view(image.data(), image.size());
+  CHECK(view.chunks() == bs.chunks());
+  CHECK(view.count() == bs.count());
+  for (std::uint32_t i = 0; i < 10 * kChunk; i += 3) {
+    if (view.get(i) != bs.get(i)) {
+      CHECK(view.get(i) == bs.get(i));
+      break;
+    }
+  }
+  CHECK(view.materialize() == bs);
+
+  const BitsetC none;
+  const std::vector<unsigned char> empty = image_of(none);
+  CHECK(BitsetC::FromImage(empty.data(), empty.size()).empty());
+}
+
+TEST_CASE("bitsetc - corrupt images are rejected") {
+  BitsetC bs;
+  for (std::uint32_t i = 10; i < 20; ++i) {
+    bs.set(i * 3);
+  }
+  REQUIRE(bs.chunk(0).kind == Kind::Array);
+  const std::vector<unsigned char> good = image_of(bs);
+  const std::size_t payload = kDesc0 + 16;
+  const auto rejected = [](const std::vector<unsigned char>& image) {
+    bool view_throws = false;
+    try {
+      const BitsetCView view(image.data(), image.size());
+    } catch (const std::invalid_argument&) {
+      view_throws = true;
+    }
+    std::stringstream strm(std::string(image.begin(), image.end()));
+    BitsetC read;
+    read.ReadFrom(strm);
+    return view_throws && strm.fail();
+  };
+  CHECK_FALSE(rejected(good));
+
+  std::vector<unsigned char> image = good;
+  image[0] ^= 1;
+  CHECK(rejected(image));
+
+  image = good;
+  image.resize(image.size() - 8);
+  CHECK(rejected(image));
+
+  image = good;
+  poke<std::uint32_t>(image, kDesc0 + kCard, 11);
+  CHECK(rejected(image));
+
+  image = good;
+  poke<std::uint16_t>(image, payload + 2, 30);  // second element == first
+  CHECK(rejected(image));
+
+  image = good;
+  image[kDesc0 + 2] = 7;  // no such container kind
+  CHECK(rejected(image));
+
+  image = good;
+  poke<std::uint32_t>(image, kDesc0 + kOffset, 0xFFFFFFF0u);
+  CHECK(rejected(image));
+
+  image = good;
+  poke<std::uint32_t>(image, kDesc0 + kElements, 0x10001);
+  CHECK(rejected(image));
+
+  BitsetC runs;
+  runs.set_range(100, 5000);
+  runs.set_range(6000, 9000);
+  REQUIRE(runs.chunk(0).kind == Kind::Run);
+  const std::vector<unsigned char> run_image = image_of(runs);
+  image = run_image;
+  poke<std::uint16_t>(image, payload + 4, 5001);  // touches the first run
+  CHECK(rejected(image));
+  image = run_image;
+  poke<std::uint16_t>(image, payload + 2, 50);  // last < start
+  CHECK(rejected(image));
+}
@@ -0,0 +1,302 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <rational/rational.hpp>
+#include <rational/rational_index.hpp>
+#include <rational/rational_map.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::int32_t kMaxInt = std::numeric_limits<std::int32_t>::max();
+
+//! Best approximation of mant / 2^shift with den <= max_den by exhaustive
+//! search in exact integer arithmetic; on equal error the smaller
+//! denominator, then the smaller numerator wins.
+Rational brute(const std::int64_t mant, const int shift, const std::int32_t max_den) {
+    const std::int64_t scale = std::int64_t(1) << shift;
+    std::int64_t best_num = 0;
+    std::int64_t best_den = 1;
+    std::int64_t best_err = mant;  // |x - 0/1| = best_err / (scale * best_den)
+    for (std::int64_t den = 1; den <= max_den; ++den) {
+        const std::int64_t near = mant * den / scale;
+        for (const std::int64_t num : { near, near + 1 }) {
+            const std::int64_t err = std::abs(mant * den - num * scale);
+            if (err * best_den < best_err * den) {
+                best_num = num;
+                best_den = den;
+                best_err = err;
+            }
+        }
+    }
+    return Rational(static_cast<std::int32_t>(best_num), static_cast<std::int32_t>(best_den));
+}
+
+}
+
+TEST_CASE("rational - from_double known values") {
+    CHECK(Rational::from_double(0.0) == Rational());
+    CHECK(Rational::from_double(-0.0) == Rational());
+    CHECK(Rational::from_double(0.75) == Rational(3, 4));
+    CHECK(Rational::from_double(-0.1, 100) == Rational(-1, 10));
+    CHECK(Rational::from_double(1.0 / 3.0) == Rational(1, 3));
+    CHECK(Rational::from_double(std::numbers::pi, 1000) == Rational(355, 113));
+    CHECK(Rational::from_double(std::numbers::pi) == Rational(1881244168, 598818617));
+    CHECK(Rational::from_double(-std::numbers::pi, 7) == Rational(-22, 7));
+    CHECK(Rational::from_double(kMaxInt) == Rational(kMaxInt, 1));
+    CHECK(Rational::from_double(-static_cast<double>(kMaxInt)) == Rational(-kMaxInt, 1));
+}
+
+TEST_CASE("rational - from_double matches exhaustive search") {
+    // Dyadic values make every tie between a convergent and a
+    // semiconvergent (a == 2t) exact; max_den walks across them.
+    for (int shift = 0; shift <= 8; ++shift) {
+        for (std::int64_t mant = 1; mant < (std::int64_t(5) << shift); ++mant) {
+            const double x = std::ldexp(static_cast<double>(mant), -shift);
+            for (std::int32_t max_den = 1; max_den <= 40; ++max_den) {
+                const Rational expected = brute(mant, shift, max_den);
+                if (Rational::from_double(x, max_den) != expected ||
+                    Rational::from_double(-x, max_den) != -expected) {
+                    INFO("x = " << x << ", max_den = " << max_den);
+                    CHECK(Rational::from_double(x, max_den) == expected);
+                    CHECK(Rational::from_double(-x, max_den) == -expected);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("rational - from_double ties") {
+    // Equal error: the smaller denominator, then the smaller numerator.
+    CHECK(Rational::from_double(0.5, 1) == Rational(0, 1));
+    CHECK(Rational::from_double(1.5, 1) == Rational(1, 1));
+    CHECK(Rational::from_double(-1.5, 1) == Rational(-1, 1));
+    CHECK(Rational::from_double(0.25, 2) == Rational(0, 1));
+    CHECK(Rational::from_double(0.75, 2) == Rational(1, 1));
+    // [0; 2, 1, 2] = 3/8: a == 2t, the semiconvergent 1/3 is closer than 1/2.
+    CHECK(Rational::from_double(0.375, 3) == Rational(1, 3));
+    CHECK(Rational::from_double(0.375, 7) == Rational(2, 5));
+}
+
+TEST_CASE("rational - from_double below 2^-10") {
+    // 2^shift does not fit into 64 bits for these.
+    CHECK(Rational::from_double(1e-300) == Rational());
+    CHECK(Rational::from_double(std::numeric_limits<double>::denorm_min()) == Rational());
+    CHECK(Rational::from_double(std::ldexp(3.0, -70)) == Rational());
+    CHECK(Rational::from_double(2e-10) == Rational());
+    // Closer to 1/kMaxInt than to 0.
+    CHECK(Rational::from_double(2.788e-10) == Rational(1, kMaxInt));
+    CHECK(Rational::from_double(-2.788e-10) == Rational(-1, kMaxInt));
+    CHECK(Rational::from_double(2.788e-10, 1000) == Rational());
+    CHECK(Rational::from_double(1e-9) == Rational(1, 1000000000));
+    CHECK(Rational::from_double(3e-9) == Rational(3, 1000000000));
+    CHECK(Rational::from_double(1.0 / 3e9, kMaxInt) == Rational(1, kMaxInt));
+    CHECK(Rational::from_double(std::ldexp(1.0, -20) / 3.0) == Rational(1, 3 << 20));
+}
+
+TEST_CASE("rational - from_double numerator bound") {
+    CHECK(Rational::from_double(2147483646.6) == Rational(kMaxInt, 1));
+    CHECK(Rational::from_double(2147483646.4) == Rational(kMaxInt - 1, 1));
+    // 3000000001/3 has too big a numerator.
+    CHECK(Rational::from_double(1e9 + 1.0 / 3.0) == Rational(2000000001, 2));
+    CHECK(Rational::from_double(-1e9 - 1.0 / 3.0) == Rational(-2000000001, 2));
+    CHECK(Rational::from_double(1e9 + 1.0 / 3.0, 1) == Rational(1000000000, 1));
+}
+
+TEST_CASE("rational - from_double errors") {
+    CHECK_THROWS_AS((void)Rational::from_double(std::nan("")), std::invalid_argument);
+    CHECK_THROWS_AS((void)Rational::from_double(1.0, 0), std::invalid_argument);
+    CHECK_THROWS_AS((void)Rational::from_double(1.0, -5), std::invalid_argument);
+    CHECK_THROWS_AS((void)Rational::from_double(HUGE_VAL), std::overflow_error);
+    CHECK_THROWS_AS((void)Rational::from_double(-HUGE_VAL), std::overflow_error);
+    CHECK_THROWS_AS((void)Rational::from_double(2147483648.0), std::overflow_error);
+    CHECK_THROWS_AS((void)Rational::from_double(-2147483648.0), std::overflow_error);
+}
+
+TEST_CASE("rational - batch from_double") {
+    std::vector<double> src(5 * 16384);
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        src[i] = std::sin(static_cast<double>(i)) * 1000.0;
+    }
+    std::vector<Rational> dst(src.size());
+    Rational::from_double(src, dst, 1000);
+    for (std::size_t i = 0; i < src.size(); i += 101) {
+        if (dst[i] != Rational::from_double(src[i], 1000)) {
+            CHECK(dst[i] == Rational::from_double(src[i], 1000));
+            break;
+        }
+    }
+
+    std::vector<Rational> small(3);
+    CHECK_THROWS_AS(Rational::from_double(src, small), std::invalid_argument);
+
+    // The error comes from the last chunk whatever the thread count is.
+    src.back() = std::nan("");
+    CHECK_THROWS_AS(Rational::from_double(src, dst), std::invalid_argument);
+    // Of two failing chunks the first one is reported.
+    src[src.size() / 2] = 1e20;
+    CHECK_THROWS_AS(Rational::from_double(src, dst), std::overflow_error);
+}
+
+TEST_CASE("rational - continued fractions") {
+    CHECK(Rational(-7, 3).continued_fraction() == std::vector<std::int32_t>{ -3, 1, 2 });
+    CHECK(Rational(355, 113).continued_fraction() == std::vector<std::int32_t>{ 3, 7, 16 });
+    CHECK(Rational(5).continued_fraction() == std::vector<std::int32_t>{ 5 });
+    for (const Rational q : { Rational(-7, 3), Rational(0), Rational(1, kMaxInt),
+        Rational(kMaxInt, 2), Rational(-kMaxInt, 1000003), Rational(1881244168, 598818617) }) {
+        CHECK(Rational::from_continued_fraction(q.continued_fraction()) == q);
+    }
+
+    CHECK_THROWS_AS((void)Rational::from_continued_fraction({}), std::invalid_argument);
+    const std::vector<std::int32_t> zero{ 1, 0, 2 };
+    CHECK_THROWS_AS((void)Rational::from_continued_fraction(zero), std::invalid_argument);
+    const std::vector<std::int32_t> big{ 1, kMaxInt };
+    CHECK_THROWS_AS((void)Rational::from_continued_fraction(big), std::overflow_error);
+}
+
+TEST_CASE("rational - map matches std::map") {
+    std::mt19937 gen(5);
+    // Few distinct keys: most erased slots get reused or pile up as tombstones.
+    std::uniform_int_distribution<std::int32_t> num(-40, 40);
+    std::uniform_int_distribution<std::int32_t> den(1, 40);
+    RationalMap<int> map;
+    std::map<Rational, int> ref;
+    for (int step = 0; step < 200000; ++step) {
+        const Rational key(num(gen), den(gen));
+        const int val = static_cast<int>(gen() % 1000);
+        const auto op = gen() % 16;
+        if (op < 6) {
+            REQUIRE(map.insert(key, val) == ref.emplace(key, val).second);
+        } else if (op < 8) {
+            map[key] += val;
+            ref[key] += val;
+        } else if (op < 14) {
+            REQUIRE(map.erase(key) == (ref.erase(key) != 0));
+        } else if (op == 14) {
+            map.reserve(static_cast<std::ptrdiff_t>(gen() % 2000));
+        } else {
+            const int* found = map.find(key);
+            const auto it = ref.find(key);
+            REQUIRE((found != nullptr) == (it != ref.end()));
+            if (found != nullptr) {
+                REQUIRE(*found == it->second);
+            }
+        }
+        REQUIRE(map.size() == static_cast<std::ptrdiff_t>(ref.size()));
+    }
+    for (const auto& [key, val] : ref) {
+        const int* found = map.find(key);
+        REQUIRE(found != nullptr);
+        CHECK(*found == val);
+    }
+    CHECK(map.find(Rational(1000, 1)) == nullptr);
+
+    for (const auto& entry : ref) {
+        CHECK(map.erase(entry.first));
+    }
+    CHECK(map.empty());
+    CHECK_FALSE(map.contains(Rational(0)));
+    // Equal values compare equal whatever form they were built from.
+    CHECK(map.insert(Rational(2, 4), 1));
+    CHECK_FALSE(map.insert(Rational(-3, -6), 2));
+    CHECK(*map.find(Rational(1, 2)) == 1);
+    map.clear();
+    CHECK(map.empty());
+    CHECK(map.find(Rational(1, 2)) == nullptr);
+}
+
+TEST_CASE("rational - map reserve does not rehash later inserts") {
+    RationalMap<int> map;
+    map.reserve(100);
+    map.insert(Rational(1, 2), 5);
+    const int* pinned = map.find(Rational(1, 2));
+    // 128 slots hold 112 elements at the 7/8 load factor.
+    map.reserve(112);
+    CHECK(map.find(Rational(1, 2)) == pinned);
+    map.reserve(10);
+    CHECK(map.find(Rational(1, 2)) == pinned);
+
+    map.reserve(1000);
+    pinned = map.find(Rational(1, 2));
+    for (std::int32_t i = 1; map.size() < 1000; ++i) {
+        map.insert(Rational(i, 3), i);
+    }
+    CHECK(map.find(Rational(1, 2)) == pinned);
+    CHECK(*pinned == 5);
+
+    // Erased slots do not count as room.
+    for (std::int32_t i = 1; map.size() > 100; ++i) {
+        map.erase(Rational(i, 3));
+    }
+    map.reserve(1000);
+    pinned = map.find(Rational(1, 2));
+    REQUIRE(pinned != nullptr);
+    for (std::int32_t i = -1; map.size() < 1000; --i) {
+        map.insert(Rational(i, 7), i);
+    }
+    CHECK(map.find(Rational(1, 2)) == pinned);
+    CHECK(*pinned == 5);
+}
+
+TEST_CASE("rational - index matches std::map") {
+    std::mt19937 gen(6);
+    std::uniform_int_distribution<std::int32_t> num(-300, 300);
+    std::uniform_int_distribution<std::int32_t> den(1, 30);
+    std::vector<std::pair<Rational, int>> entries;
+    std::map<Rational, int> ref;
+    for (int i = 0; i < 3000; ++i) {
+        const Rational key(num(gen), den(gen));
+        entries.emplace_back(key, i);
+        ref.emplace(key, i);  // first entry wins, as in assign()
+    }
+    RationalIndex<int> index;
+    index.assign(entries);
+    for (int step = 0; step < 20000; ++step) {
+        const Rational key(num(gen), den(gen));
+        const auto op = gen() % 4;
+        if (op == 0) {
+            REQUIRE(index.insert(key, step) == ref.emplace(key, step).second);
+        } else if (op == 1) {
+            REQUIRE(index.erase(key) == (ref.erase(key) != 0));
+        } else {
+            const auto lower = std::distance(ref.begin(), ref.lower_bound(key));
+            const auto upper = std::distance(ref.begin(), ref.upper_bound(key));
+            REQUIRE(index.lower_bound(key) == lower);
+            REQUIRE(index.upper_bound(key) == upper);
+            const int* found = index.find(key);
+            REQUIRE((found != nullptr) == (lower != upper));
+            if (found != nullptr) {
+                REQUIRE(*found == ref.at(key));
+            }
+        }
+    }
+    REQUIRE(index.size() == static_cast<std::ptrdiff_t>(ref.size()));
+    std::ptrdiff_t pos = 0;
+    for (const auto& [key, val] : ref) {
+        CHECK(index.key(pos) == key);
+        CHECK(index.value(pos) == val);
+        ++pos;
+    }
+    CHECK(index.lower_bound(Rational(-1000)) == 0);
+    CHECK(index.upper_bound(Rational(1000)) == index.size());
+
+    RationalIndex<int> empty;
+    CHECK(empty.lower_bound(Rational(1)) == 0);
+    CHECK(empty.upper_bound(Rational(1)) == 0);
+    CHECK(empty.find(Rational(1)) == nullptr);
+    CHECK(empty.insert(Rational(1), 7));
+    CHECK(empty.lower_bound(Rational(1)) == 0);
+    CHECK(empty.upper_bound(Rational(1)) == 1);
+}